@@ -0,0 +1,364 @@
+﻿#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <cstddef>
+#include "NodeSearch.h"
+#include "NodePool.h"
+
+// B+-tree 的節點結構：內部節點只存分隔鍵，所有鍵值都在葉節點，葉節點以 prev / next 串成雙向鏈結
+struct BPlusNode {
+    int t; // 最小度數
+    bool leaf; // 是否為葉節點
+    std::vector<int> keys; // 葉節點為資料鍵值，內部節點為分隔鍵 (右子樹的最小鍵值)
+    std::vector<BPlusNode*> children; // 內部節點的子節點，數量為 keys.size() + 1
+    BPlusNode* prev; // 左邊的葉節點
+    BPlusNode* next; // 右邊的葉節點
+
+    BPlusNode(int t, bool leaf) : t(t), leaf(leaf), prev(nullptr), next(nullptr) {
+        keys.reserve(2 * t - 1);
+        if (!leaf) children.reserve(2 * t);
+    }
+
+    // 由 NodePool 重複使用節點時重新初始化
+    void reset(int t, bool leaf) {
+        this->t = t;
+        this->leaf = leaf;
+        keys.clear();
+        children.clear();
+        prev = next = nullptr;
+    }
+};
+
+// B+-tree 類別：鍵值不重複，支援依序走訪與範圍查詢
+class BPlusTree {
+    BPlusNode* root; // 樹的根節點
+    int t; // 最小度數，每個節點最多 2t-1 個鍵值
+    size_t count; // 鍵值總數
+    NodePool<BPlusNode> pool; // 所有節點皆由此配置
+
+    // 節點中小於等於 key 的分隔鍵個數，即 key 所在的子節點位置
+    static int childIndex(const BPlusNode* node, int key) {
+        int i = nodesearch::rank(node->keys.data(), static_cast<int>(node->keys.size()), key);
+        if (i < static_cast<int>(node->keys.size()) && node->keys[i] == key) i++;
+        return i;
+    }
+
+    // 分裂已滿的子節點；葉節點把右半部的第一個鍵值複製到父節點，內部節點則把中間鍵值上移
+    void splitChild(BPlusNode* parent, int i) {
+        BPlusNode* y = parent->children[i];
+        BPlusNode* z = pool.create(t, y->leaf);
+        int separator;
+
+        if (y->leaf) {
+            z->keys.assign(y->keys.begin() + t, y->keys.end());
+            y->keys.resize(t);
+            separator = z->keys[0];
+
+            // 將 z 接到葉節點鏈結中 y 的右邊
+            z->next = y->next;
+            z->prev = y;
+            if (y->next) y->next->prev = z;
+            y->next = z;
+        }
+        else {
+            separator = y->keys[t - 1];
+            z->keys.assign(y->keys.begin() + t, y->keys.end());
+            z->children.assign(y->children.begin() + t, y->children.end());
+            y->keys.resize(t - 1);
+            y->children.resize(t);
+        }
+
+        parent->keys.insert(parent->keys.begin() + i, separator);
+        parent->children.insert(parent->children.begin() + i + 1, z);
+    }
+
+    // 從左兄弟借一個鍵值給第 idx 個子節點
+    void borrowFromPrev(BPlusNode* node, int idx) {
+        BPlusNode* child = node->children[idx];
+        BPlusNode* sibling = node->children[idx - 1];
+
+        if (child->leaf) { // 葉節點直接搬移鍵值，再更新分隔鍵
+            child->keys.insert(child->keys.begin(), sibling->keys.back());
+            sibling->keys.pop_back();
+            node->keys[idx - 1] = child->keys[0];
+        }
+        else { // 內部節點經由父節點旋轉
+            child->keys.insert(child->keys.begin(), node->keys[idx - 1]);
+            child->children.insert(child->children.begin(), sibling->children.back());
+            node->keys[idx - 1] = sibling->keys.back();
+            sibling->keys.pop_back();
+            sibling->children.pop_back();
+        }
+    }
+
+    // 從右兄弟借一個鍵值給第 idx 個子節點
+    void borrowFromNext(BPlusNode* node, int idx) {
+        BPlusNode* child = node->children[idx];
+        BPlusNode* sibling = node->children[idx + 1];
+
+        if (child->leaf) {
+            child->keys.push_back(sibling->keys[0]);
+            sibling->keys.erase(sibling->keys.begin());
+            node->keys[idx] = sibling->keys[0];
+        }
+        else {
+            child->keys.push_back(node->keys[idx]);
+            child->children.push_back(sibling->children[0]);
+            node->keys[idx] = sibling->keys[0];
+            sibling->keys.erase(sibling->keys.begin());
+            sibling->children.erase(sibling->children.begin());
+        }
+    }
+
+    // 合併第 idx 個子節點與其右兄弟
+    void merge(BPlusNode* node, int idx) {
+        BPlusNode* child = node->children[idx];
+        BPlusNode* sibling = node->children[idx + 1];
+
+        if (child->leaf) { // 葉節點的分隔鍵只是複本，直接捨棄
+            child->keys.insert(child->keys.end(), sibling->keys.begin(), sibling->keys.end());
+            child->next = sibling->next;
+            if (sibling->next) sibling->next->prev = child;
+        }
+        else {
+            child->keys.push_back(node->keys[idx]);
+            child->keys.insert(child->keys.end(), sibling->keys.begin(), sibling->keys.end());
+            child->children.insert(child->children.end(), sibling->children.begin(), sibling->children.end());
+        }
+
+        node->keys.erase(node->keys.begin() + idx);
+        node->children.erase(node->children.begin() + idx + 1);
+        pool.destroy(sibling);
+    }
+
+    // 讓第 idx 個子節點至少有 t 個鍵值，回傳接下來應進入的子節點位置
+    int fill(BPlusNode* node, int idx) {
+        if (idx != 0 && static_cast<int>(node->children[idx - 1]->keys.size()) >= t) {
+            borrowFromPrev(node, idx);
+        }
+        else if (idx != static_cast<int>(node->keys.size()) && static_cast<int>(node->children[idx + 1]->keys.size()) >= t) {
+            borrowFromNext(node, idx);
+        }
+        else if (idx != static_cast<int>(node->keys.size())) {
+            merge(node, idx);
+        }
+        else {
+            merge(node, idx - 1);
+            idx--;
+        }
+        return idx;
+    }
+
+    // 找到 key 應在的葉節點
+    const BPlusNode* findLeaf(int key) const {
+        const BPlusNode* node = root;
+        while (node && !node->leaf) node = node->children[childIndex(node, key)];
+        return node;
+    }
+
+    // 遞迴地打印樹的結構
+    void printTree(const BPlusNode* node, int level) const {
+        std::cout << std::string(level * 4, ' ');
+        for (int key : node->keys) std::cout << key << " ";
+        std::cout << (node->leaf ? "*\n" : "\n"); // 以 * 標示葉節點
+        for (const BPlusNode* child : node->children) printTree(child, level + 1);
+    }
+
+public:
+    // 依鍵值由小到大走訪的雙向迭代器，end() 以空的葉節點指標表示
+    class const_iterator {
+        friend class BPlusTree;
+        const BPlusTree* tree;
+        const BPlusNode* leaf;
+        int index;
+
+        const_iterator(const BPlusTree* tree, const BPlusNode* leaf, int index) : tree(tree), leaf(leaf), index(index) {
+            // 位置剛好在葉節點尾端時，移到下一個葉節點的開頭
+            if (this->leaf && this->index == static_cast<int>(this->leaf->keys.size())) {
+                this->leaf = this->leaf->next;
+                this->index = 0;
+            }
+        }
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator() : tree(nullptr), leaf(nullptr), index(0) {}
+
+        reference operator*() const { return leaf->keys[index]; }
+        pointer operator->() const { return &leaf->keys[index]; }
+
+        const_iterator& operator++() {
+            if (++index == static_cast<int>(leaf->keys.size())) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        const_iterator& operator--() {
+            if (!leaf) { // 從 end() 退回最後一個鍵值
+                leaf = tree->lastLeaf();
+                index = static_cast<int>(leaf->keys.size()) - 1;
+            }
+            else if (index == 0) {
+                leaf = leaf->prev;
+                index = static_cast<int>(leaf->keys.size()) - 1;
+            }
+            else {
+                index--;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+        const_iterator operator--(int) { const_iterator old = *this; --*this; return old; }
+
+        bool operator==(const const_iterator& other) const { return leaf == other.leaf && index == other.index; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+    using iterator = const_iterator;
+
+    // range() 的結果，可直接用於 range-based for
+    struct Range {
+        const_iterator first, last;
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+    };
+
+    // 初始化 B+-tree
+    BPlusTree(int t) : root(nullptr), t(t), count(0) {}
+
+    ~BPlusTree() = default;
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // 插入鍵值，鍵值已存在時回傳 false
+    bool insert(int key) {
+        if (!root) {
+            root = pool.create(t, true);
+        }
+        else if (static_cast<int>(root->keys.size()) == 2 * t - 1) { // 根節點已滿時先分裂
+            BPlusNode* newRoot = pool.create(t, false);
+            newRoot->children.push_back(root);
+            root = newRoot;
+            splitChild(root, 0);
+        }
+
+        BPlusNode* node = root;
+        while (!node->leaf) { // 由上而下預先分裂已滿的子節點
+            int i = childIndex(node, key);
+            if (static_cast<int>(node->children[i]->keys.size()) == 2 * t - 1) {
+                splitChild(node, i);
+                if (key >= node->keys[i]) i++;
+            }
+            node = node->children[i];
+        }
+
+        int i = nodesearch::rank(node->keys.data(), static_cast<int>(node->keys.size()), key);
+        if (i < static_cast<int>(node->keys.size()) && node->keys[i] == key) return false;
+        node->keys.insert(node->keys.begin() + i, key);
+        count++;
+        return true;
+    }
+
+    // 刪除鍵值，找不到時回傳 false
+    bool remove(int key) {
+        if (!root) return false;
+
+        BPlusNode* node = root;
+        while (!node->leaf) { // 進入子節點前確保其鍵值足夠，刪除後不需回溯
+            int i = childIndex(node, key);
+            if (static_cast<int>(node->children[i]->keys.size()) < t) {
+                i = fill(node, i);
+            }
+            node = node->children[i];
+        }
+
+        int i = nodesearch::rank(node->keys.data(), static_cast<int>(node->keys.size()), key);
+        bool found = i < static_cast<int>(node->keys.size()) && node->keys[i] == key;
+        if (found) {
+            node->keys.erase(node->keys.begin() + i);
+            count--;
+        }
+
+        if (root->keys.empty()) { // 根節點已空，樹高減一
+            BPlusNode* old = root;
+            root = root->leaf ? nullptr : root->children[0];
+            pool.destroy(old);
+        }
+        return found;
+    }
+
+    // 判斷鍵值是否存在
+    bool contains(int key) const {
+        const BPlusNode* leaf = findLeaf(key);
+        if (!leaf) return false;
+        int i = nodesearch::rank(leaf->keys.data(), static_cast<int>(leaf->keys.size()), key);
+        return i < static_cast<int>(leaf->keys.size()) && leaf->keys[i] == key;
+    }
+
+    // 查詢鍵值，找不到時回傳 end()
+    const_iterator find(int key) const {
+        const_iterator it = lower_bound(key);
+        return (it != end() && *it == key) ? it : end();
+    }
+
+    // 第一個不小於 key 的位置
+    const_iterator lower_bound(int key) const {
+        const BPlusNode* leaf = findLeaf(key);
+        if (!leaf) return end();
+        return const_iterator(this, leaf, nodesearch::rank(leaf->keys.data(), static_cast<int>(leaf->keys.size()), key));
+    }
+
+    // 第一個大於 key 的位置
+    const_iterator upper_bound(int key) const {
+        const BPlusNode* leaf = findLeaf(key);
+        if (!leaf) return end();
+        return const_iterator(this, leaf, childIndex(leaf, key));
+    }
+
+    // 閉區間 [lo, hi] 內的所有鍵值：一次往下搜尋，之後沿葉節點鏈結依序讀取
+    Range range(int lo, int hi) const {
+        if (hi < lo) return { end(), end() };
+        return { lower_bound(lo), upper_bound(hi) };
+    }
+
+    const_iterator begin() const {
+        const BPlusNode* node = root;
+        while (node && !node->leaf) node = node->children[0];
+        return const_iterator(this, node, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, nullptr, 0);
+    }
+
+    // 最右邊的葉節點
+    const BPlusNode* lastLeaf() const {
+        const BPlusNode* node = root;
+        while (node && !node->leaf) node = node->children.back();
+        return node;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // 清空整棵樹
+    void clear() {
+        root = nullptr;
+        count = 0;
+        pool.reset();
+    }
+
+    // 打印整棵 B+-tree
+    void printTree() const {
+        if (root) printTree(root, 0);
+    }
+};
@@ -0,0 +1,1372 @@
+﻿#pragma once
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <optional>
+#include "BulkLoad.h"
+#include "NodeSearch.h"
+#include "NodePool.h"
+#include "NodeRebalance.h"
+#include "Snapshot.h"
+#include "TreeStats.h"
+#include "ThreadPool.h"
+#include "FrozenIndex.h"
+#include "TreeRender.h"
+#include "MembershipFilter.h"
+
+// B-tree 的節點結構
+struct BTreeNode {
+    int t; // 最小度數
+    std::vector<int> keys; // 儲存鍵值的陣列
+    std::vector<BTreeNode*> children; // 儲存子節點指標的陣列
+    bool leaf; // 是否為葉節點
+    size_t subtreeSize = 0; // 子樹的鍵值總數，只在啟用 order statistics 時維護
+    std::atomic<int> refs{ 1 }; // 指向此節點的父節點與快照根的個數，大於 1 時節點唯讀 (寫入前需先複製)
+
+    // 節點的構造函式，初始化鍵值和子節點
+    BTreeNode(int t, bool leaf) : t(t), leaf(leaf) {
+        keys.reserve(2 * t - 1); // 預留最多 2t-1 個鍵值的空間
+        children.resize(2 * t, nullptr); // 初始化最多 2t 個子節點的空間
+    }
+
+    // 由 NodePool 重複使用節點時重新初始化，保留 keys 的容量
+    void reset(int t, bool leaf) {
+        this->t = t;
+        this->leaf = leaf;
+        subtreeSize = 0;
+        refs.store(1, std::memory_order_relaxed);
+        keys.clear();
+        keys.reserve(2 * t - 1); // compact 可能已釋放閒置節點的緩衝區
+        children.assign(2 * t, nullptr);
+    }
+};
+
+// B-tree 類別
+class BTree {
+    BTreeNode* root; // 樹的根節點
+    int t; // B-tree 的最小度數
+    NodePool<BTreeNode> pool; // 所有節點皆由此配置
+    mutable OpStats stats; // 結構操作計數 (find 為 const 也需更新)
+    bool orderStatistics; // 是否維護每個節點的 subtreeSize，以支援 rank / select / countRange
+    std::atomic<size_t> liveSnapshots{ 0 }; // 尚未釋放的 Snapshot 個數
+    std::mutex retiredLock; // 保護 retired
+    std::vector<BTreeNode*> retired; // 快照在其他執行緒釋放的節點，由下一次寫入歸還 pool (pool 不是執行緒安全的)
+    std::atomic<bool> hasRetired{ false };
+    std::vector<BTreeNode*> spine; // 根到最右葉節點的路徑，非空時處於遞增插入模式 (見 appendToSpine)
+    bool compacting = false; // compact 的一輪是否進行到一半
+    int compactCursor = INT32_MIN; // 進行中的一輪已處理完的子樹都落在此鍵值 (含) 之前
+    std::optional<BlockedBloomFilter> filter; // 啟用 membership filter 時才存在 (見 enableMembershipFilter)
+    double filterBitsPerKey = 10;
+    bool reportMissing = true; // remove 遇到不存在的鍵值時是否輸出訊息
+    size_t filterStale = 0; // 上次重建後刪除的鍵值數，這些鍵值仍留在 filter 中
+
+    // 寫入前取得 slot 所指節點的獨佔版本：節點仍被快照共用時複製一份並改由 slot 指向複本，
+    // 原節點的子節點改為兩個版本共用。寫入一律由根往下經過 own，因此每次寫入只複製路徑上的 O(height) 個節點
+    BTreeNode* own(BTreeNode*& slot) {
+        BTreeNode* node = slot;
+        if (node->refs.load(std::memory_order_acquire) == 1) return node;
+        HW6_COUNT(nodesCopied);
+        BTreeNode* copy = pool.create(t, node->leaf);
+        copy->keys = node->keys;
+        copy->children = node->children;
+        copy->subtreeSize = node->subtreeSize;
+        for (BTreeNode* child : copy->children) {
+            if (child) child->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        release(node, false);
+        slot = copy;
+        return copy;
+    }
+
+    // 放棄一個指向 node 的參考，最後一個參考消失時連同子樹一併回收；
+    // deferred 為 true 時 (快照在任意執行緒釋放) 節點先放入 retired，等寫入端歸還 pool
+    void release(BTreeNode* node, bool deferred) {
+        if (node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        if (!node->leaf) {
+            for (BTreeNode* child : node->children) {
+                if (child) release(child, deferred);
+            }
+        }
+        if (deferred) {
+            std::lock_guard<std::mutex> lock(retiredLock);
+            retired.push_back(node);
+            hasRetired.store(true, std::memory_order_release);
+        }
+        else {
+            pool.destroy(node);
+        }
+    }
+
+    // 將快照釋放的節點歸還 pool，在每個寫入操作開始時呼叫
+    void reclaim() {
+        if (!hasRetired.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(retiredLock);
+        for (BTreeNode* node : retired) pool.destroy(node);
+        retired.clear();
+        hasRetired.store(false, std::memory_order_relaxed);
+    }
+
+    // 以目前所有的鍵值重建 membership filter，並預留一倍的容量給之後的插入
+    void rebuildFilter() {
+        if (!filter) return;
+        size_t keys = 0;
+        if (orderStatistics) keys = size();
+        else forEachInRange(INT32_MIN, INT32_MAX, [&](int) { keys++; });
+        filter->reserve(std::max<size_t>(2 * keys, 1024), filterBitsPerKey);
+        forEachInRange(INT32_MIN, INT32_MAX, [&](int key) { filter->add(key); });
+        filterStale = 0;
+    }
+
+    // 新鍵值加入 filter；加入的鍵值超出容量 (誤判率開始上升) 時先重建
+    void filterAdd(int k) {
+        if (!filter) return;
+        if (filter->count() >= filter->capacity(filterBitsPerKey)) rebuildFilter();
+        filter->add(k);
+    }
+
+    // 記錄刪除了 n 個鍵值；filter 中過時的鍵值超過一半時重建。每次重建之前至少有與鍵值數同階的插入或刪除，均攤 O(1)
+    void filterRemoved(size_t n) {
+        if (!filter || n == 0) return;
+        filterStale += n;
+        if (filterStale * 2 > filter->count()) rebuildFilter();
+    }
+
+    // 查詢鍵值但不計入 operations：先問 membership filter，filter 無法排除時才由根往下搜尋
+    const int* locate(int k) const {
+        if (filter && !filter->mayContain(k)) {
+            HW6_COUNT(filterRejects);
+            return nullptr;
+        }
+        const BTreeNode* node = root;
+        while (node) {
+            HW6_COUNT(nodesVisited);
+            int n = static_cast<int>(node->keys.size());
+            int i = nodesearch::rank(node->keys.data(), n, k); // 節點內第一個不小於 k 的位置
+            if (i < n && node->keys[i] == k) return &node->keys[i];
+            if (node->leaf) return nullptr;
+            node = node->children[i];
+        }
+        return nullptr;
+    }
+
+    // 由鍵值數與子節點的 subtreeSize 重新計算 node 的 subtreeSize
+    static void recount(BTreeNode* node) {
+        size_t size = node->keys.size();
+        if (!node->leaf) {
+            for (size_t i = 0; i <= node->keys.size(); i++) size += node->children[i]->subtreeSize;
+        }
+        node->subtreeSize = size;
+    }
+
+    // 由下而上重新計算整棵子樹的 subtreeSize
+    static void recountAll(BTreeNode* node) {
+        if (!node->leaf) {
+            for (size_t i = 0; i <= node->keys.size(); i++) recountAll(node->children[i]);
+        }
+        recount(node);
+    }
+
+    // node 子樹中小於 k (inclusive 時為小於等於 k) 的鍵值個數：沿一條路徑往下，累加左邊的鍵值與整棵左子樹的大小
+    static size_t countBelow(const BTreeNode* node, int k, bool inclusive) {
+        size_t count = 0;
+        while (node) {
+            int i = inclusive ? static_cast<int>(std::upper_bound(node->keys.begin(), node->keys.end(), k) - node->keys.begin())
+                              : nodesearch::rank(node->keys.data(), static_cast<int>(node->keys.size()), k);
+            count += i;
+            if (node->leaf) break;
+            for (int j = 0; j < i; j++) count += node->children[j]->subtreeSize;
+            node = node->children[i]; // 與 k 相等或跨越 k 的鍵值只可能在這個子樹中
+        }
+        return count;
+    }
+
+    // node 子樹中第 k 小的鍵值 (由 0 起算)，k 超出範圍時回傳 nullptr
+    static const int* select(const BTreeNode* node, size_t k) {
+        if (!node || k >= node->subtreeSize) return nullptr;
+        while (!node->leaf) {
+            size_t i = 0;
+            while (k >= node->children[i]->subtreeSize) { // 跳過整棵左子樹與其後的鍵值
+                k -= node->children[i]->subtreeSize;
+                if (k == 0) return &node->keys[i];
+                k--;
+                i++;
+            }
+            node = node->children[i];
+        }
+        return &node->keys[k];
+    }
+
+    static void requireOrderStatistics(bool enabled) {
+        if (!enabled) throw std::logic_error("BTree 未啟用 order statistics");
+    }
+
+    // 提供 rebalance:: 演算法存取節點的介面；寫入子節點前一律經過 own，維持 2t 個子節點欄位並把空出的欄位設為 nullptr
+    struct NodeAccess {
+        BTree& tree;
+
+        static bool leaf(const BTreeNode* node) { return node->leaf; }
+        static int count(const BTreeNode* node) { return static_cast<int>(node->keys.size()); }
+        static int key(const BTreeNode* node, int i) { return node->keys[i]; }
+        static void setKey(BTreeNode* node, int i, int k) { node->keys[i] = k; }
+        static BTreeNode* ref(BTreeNode* node) { return node; }
+        static BTreeNode* childRef(const BTreeNode* node, int i) { return node->children[i]; }
+        static void setChild(BTreeNode* node, int i, BTreeNode* child) { node->children[i] = child; }
+        static int childCount(const BTreeNode* node, int i) { return count(node->children[i]); }
+
+        BTreeNode* child(BTreeNode* node, int i) { return tree.own(node->children[i]); }
+        BTreeNode* create(bool leaf) { return tree.pool.create(tree.t, leaf); }
+        void destroy(BTreeNode* node) { tree.pool.destroy(node); }
+
+        static void insertKey(BTreeNode* node, int i, int k) { node->keys.insert(node->keys.begin() + i, k); }
+        static void eraseKey(BTreeNode* node, int i) { node->keys.erase(node->keys.begin() + i); }
+        static void insertChild(BTreeNode* node, int i, BTreeNode* child) {
+            node->children.insert(node->children.begin() + i, child);
+            node->children.pop_back(); // 最後一個欄位必為空
+        }
+        static void eraseChild(BTreeNode* node, int i) {
+            node->children.erase(node->children.begin() + i);
+            node->children.push_back(nullptr);
+        }
+        static void truncate(BTreeNode* node, int n) {
+            int old = count(node);
+            node->keys.resize(n);
+            if (!node->leaf) std::fill(node->children.begin() + n + 1, node->children.begin() + old + 1, nullptr);
+        }
+        static void appendKeys(BTreeNode* dst, const BTreeNode* src, int from) {
+            dst->keys.insert(dst->keys.end(), src->keys.begin() + from, src->keys.end());
+        }
+
+        void borrowFromPrev(BTreeNode* node, int idx) { tree.borrowFromPrev(node, idx); }
+        void borrowFromNext(BTreeNode* node, int idx) { tree.borrowFromNext(node, idx); }
+        void merge(BTreeNode* node, int idx) { tree.merge(node, idx); }
+    };
+
+    // 分裂子節點 (見 rebalance::splitChild)
+    void splitChild(BTreeNode* node, int i) {
+        HW6_COUNT(splitChild);
+        NodeAccess nodes{ *this };
+        rebalance::splitChild(nodes, node, i, t);
+
+        if (orderStatistics) { // node 的大小不變，z 與中間鍵值從 y 分出
+            BTreeNode* y = node->children[i];
+            BTreeNode* z = node->children[i + 1];
+            recount(z);
+            y->subtreeSize -= z->subtreeSize + 1;
+        }
+    }
+
+    // 插入鍵值到非滿節點，回傳鍵值是否落在整棵子樹的最右端 (沿途都走最右的子節點，並接在葉節點最後)
+    bool insertNonFull(BTreeNode* node, int k) {
+        HW6_COUNT(nodesVisited);
+        if (orderStatistics) node->subtreeSize++; // 鍵值一定會插入此子樹
+        int i = static_cast<int>(node->keys.size()) - 1; // 初始化索引為最後一個鍵值
+
+        if (node->leaf) { // 如果是葉節點
+            node->keys.push_back(0); // 暫時擴展空間
+            while (i >= 0 && k < node->keys[i]) { // 從後向前移動鍵值
+                node->keys[i + 1] = node->keys[i];
+                i--;
+            }
+            node->keys[i + 1] = k; // 插入鍵值
+            return i + 2 == static_cast<int>(node->keys.size());
+        }
+        else { // 如果是內部節點
+            while (i >= 0 && k < node->keys[i]) {
+                i--;
+            }
+            i++;
+
+            if (static_cast<int>(node->children[i]->keys.size()) == 2 * t - 1) { // 如果子節點已滿
+                splitChild(node, i); // 分裂子節點
+                if (k > node->keys[i]) {
+                    i++;
+                }
+            }
+            bool last = i == static_cast<int>(node->keys.size());
+            return insertNonFull(own(node->children[i]), k) && last; // 遞迴插入到子節點
+        }
+    }
+
+    // 由根節點沿最右的子節點往下記錄 spine，之後大於等於最大值的鍵值可直接接在最右葉節點
+    void buildSpine() {
+        spine.clear();
+        for (BTreeNode* node = root; node; node = node->leaf ? nullptr : node->children[node->keys.size()]) spine.push_back(node);
+    }
+
+    // 把 k (不小於目前的最大值) 接在最右葉節點之後，不必由根往下搜尋。
+    // 節點已滿時偏右分裂：原節點保留 2t-2 個鍵值離開 spine，新的右節點只放新鍵值 (或一個分隔鍵與兩個子節點)，
+    // 因此遞增插入建出的節點幾乎全滿；代價是 spine 上的節點可能不足 t-1 個鍵值，由 sealSpine 補足
+    void appendToSpine(int k) {
+        HW6_COUNT(nodesVisited);
+        BTreeNode* leaf = spine.back();
+        if (static_cast<int>(leaf->keys.size()) < 2 * t - 1) {
+            leaf->keys.push_back(k);
+            if (orderStatistics) {
+                for (BTreeNode* node : spine) node->subtreeSize++;
+            }
+            return;
+        }
+
+        HW6_COUNT(splitChild);
+        int separator = leaf->keys.back(); // 最右葉節點的最大鍵值上移，新鍵值單獨放入新的最右葉節點
+        leaf->keys.pop_back();
+        BTreeNode* right = pool.create(t, true);
+        right->keys.push_back(k);
+        if (orderStatistics) {
+            recount(leaf);
+            recount(right);
+        }
+        spine.back() = right;
+
+        int level = static_cast<int>(spine.size()) - 2;
+        for (; level >= 0; level--) {
+            BTreeNode* parent = spine[level];
+            int n = static_cast<int>(parent->keys.size());
+            if (n < 2 * t - 1) { // 父節點未滿：分隔鍵與新節點接在最後
+                parent->keys.push_back(separator);
+                parent->children[n + 1] = right;
+                break;
+            }
+            HW6_COUNT(splitChild);
+            BTreeNode* sibling = pool.create(t, false); // 父節點已滿：最右的子節點與新節點改掛在新的右兄弟下
+            sibling->keys.push_back(separator);
+            sibling->children[0] = parent->children[n];
+            sibling->children[1] = right;
+            parent->children[n] = nullptr;
+            separator = parent->keys.back();
+            parent->keys.pop_back();
+            if (orderStatistics) {
+                recount(parent);
+                recount(sibling);
+            }
+            spine[level] = sibling;
+            right = sibling;
+        }
+
+        if (level < 0) { // 根節點也已分裂，樹高加一
+            BTreeNode* newRoot = pool.create(t, false);
+            newRoot->keys.push_back(separator);
+            newRoot->children[0] = root;
+            newRoot->children[1] = right;
+            if (orderStatistics) recount(newRoot);
+            root = newRoot;
+            spine.insert(spine.begin(), root);
+        }
+        else if (orderStatistics) {
+            for (int i = 0; i <= level; i++) spine[i]->subtreeSize++;
+        }
+    }
+
+    // 結束遞增插入模式：由下而上讓 spine 上不足 t-1 個鍵值的節點向左兄弟借用或與之合併，
+    // 恢復一般 B-tree 的性質後才能執行刪除、批次操作或建立快照
+    void sealSpine() {
+        if (spine.empty()) return;
+        for (int level = static_cast<int>(spine.size()) - 1; level > 0; level--) {
+            BTreeNode* parent = spine[level - 1];
+            int idx = static_cast<int>(parent->keys.size()); // spine[level] 是 parent 最右的子節點
+            BTreeNode* sibling = parent->children[idx - 1];
+            int deficit = t - 1 - static_cast<int>(spine[level]->keys.size());
+            if (deficit <= 0) continue;
+            if (sibling->keys.size() + spine[level]->keys.size() + 1 <= 2 * static_cast<size_t>(t) - 1) {
+                merge(parent, idx - 1);
+            }
+            else {
+                for (int i = 0; i < deficit; i++) borrowFromPrev(parent, idx);
+            }
+        }
+        if (root->keys.empty() && !root->leaf) { // 根節點唯一的分隔鍵被合併下去，樹高減一
+            BTreeNode* tmp = root;
+            root = root->children[0];
+            pool.destroy(tmp);
+        }
+        spine.clear();
+    }
+
+    // 從節點中刪除鍵值，回傳是否找到並刪除；remove(int) 已先以 locate 走過一次並計入 nodesVisited，這裡不再重複計算
+    bool remove(BTreeNode* node, int k) {
+        bool removed = true;
+        int idx = std::lower_bound(node->keys.begin(), node->keys.end(), k) - node->keys.begin(); // 找到鍵值的位置
+
+        if (idx < node->keys.size() && node->keys[idx] == k) { // 如果鍵值在節點中
+            if (node->leaf) { // 如果是葉節點
+                node->keys.erase(node->keys.begin() + idx); // 直接刪除鍵值
+            }
+            else { // 如果是內部節點
+                if (node->children[idx]->keys.size() >= t) { // 如果左子節點有足夠鍵值
+                    int pred = getPredecessor(node, idx); // 獲取前驅鍵值
+                    node->keys[idx] = pred; // 替換為前驅鍵值
+                    removed = remove(own(node->children[idx]), pred); // 遞迴刪除前驅鍵值
+                }
+                else if (node->children[idx + 1]->keys.size() >= t) { // 如果右子節點有足夠鍵值
+                    int succ = getSuccessor(node, idx); // 獲取後繼鍵值
+                    node->keys[idx] = succ; // 替換為後繼鍵值
+                    removed = remove(own(node->children[idx + 1]), succ); // 遞迴刪除後繼鍵值
+                }
+                else { // 左右子節點都不夠，合併節點
+                    merge(node, idx);
+                    removed = remove(own(node->children[idx]), k); // 遞迴刪除鍵值
+                }
+            }
+        }
+        else { // 如果鍵值不在節點中
+            if (node->leaf) { // 如果是葉節點
+                std::cout << "Key " << k << " not found in the tree.\n";
+                return false;
+            }
+
+            bool flag = (idx == node->keys.size()); // 是否在最後一個子節點中
+
+            if (node->children[idx]->keys.size() < t) { // 如果子節點鍵值數不足
+                fill(node, idx); // 處理子節點數量不足的情況
+            }
+
+            if (flag && idx > node->keys.size()) {
+                removed = remove(own(node->children[idx - 1]), k); // 從左子節點中刪除
+            }
+            else {
+                removed = remove(own(node->children[idx]), k); // 從右子節點中刪除
+            }
+        }
+
+        if (removed && orderStatistics) node->subtreeSize--;
+        return removed;
+    }
+
+    // 獲取鍵值的前驅
+    int getPredecessor(BTreeNode* node, int idx) {
+        HW6_COUNT(getPredecessor);
+        BTreeNode* cur = node->children[idx]; // 進入左子節點
+        while (!cur->leaf) {
+            cur = cur->children[cur->keys.size()]; // 找到最右邊的鍵值
+        }
+        return cur->keys[cur->keys.size() - 1];
+    }
+
+    // 獲取鍵值的後繼
+    int getSuccessor(BTreeNode* node, int idx) {
+        HW6_COUNT(getSuccessor);
+        BTreeNode* cur = node->children[idx + 1]; // 進入右子節點
+        while (!cur->leaf) {
+            cur = cur->children[0]; // 找到最左邊的鍵值
+        }
+        return cur->keys[0];
+    }
+
+    // 處理子節點數量不足的情況
+    void fill(BTreeNode* node, int idx) {
+        NodeAccess nodes{ *this };
+        rebalance::fill(nodes, node, idx, t);
+    }
+
+    // 從左兄弟借用鍵值
+    void borrowFromPrev(BTreeNode* node, int idx) {
+        HW6_COUNT(borrowFromPrev);
+        NodeAccess nodes{ *this };
+        rebalance::borrowFromPrev(nodes, node, idx);
+
+        if (orderStatistics) { // 一個鍵值加上搬過來的子樹從左兄弟移到 child
+            BTreeNode* child = node->children[idx];
+            size_t moved = 1 + (child->leaf ? 0 : child->children[0]->subtreeSize);
+            child->subtreeSize += moved;
+            node->children[idx - 1]->subtreeSize -= moved;
+        }
+    }
+
+    // 從右兄弟借用鍵值
+    void borrowFromNext(BTreeNode* node, int idx) {
+        HW6_COUNT(borrowFromNext);
+        NodeAccess nodes{ *this };
+        rebalance::borrowFromNext(nodes, node, idx);
+
+        if (orderStatistics) { // 一個鍵值加上搬過來的子樹從右兄弟移到 child
+            BTreeNode* child = node->children[idx];
+            size_t moved = 1 + (child->leaf ? 0 : child->children[child->keys.size()]->subtreeSize);
+            child->subtreeSize += moved;
+            node->children[idx + 1]->subtreeSize -= moved;
+        }
+    }
+
+    // 合併節點
+    void merge(BTreeNode* node, int idx) {
+        HW6_COUNT(merge);
+        size_t moved = node->children[idx + 1]->subtreeSize + 1; // 右兄弟與分隔鍵，合併後右兄弟即被回收
+        NodeAccess nodes{ *this };
+        rebalance::merge(nodes, node, idx);
+        if (orderStatistics) node->children[idx]->subtreeSize += moved;
+    }
+
+    // 批次操作期間節點可能暫時超出上限，讓子節點欄位至少容納 keys.size() + 1 個，平時維持 2t 個
+    void fitChildren(BTreeNode* node) {
+        node->children.resize(std::max<size_t>(2 * t, node->keys.size() + 1), nullptr);
+    }
+
+    // 將超出上限的第 i 個子節點一次切成數個大小平均的節點，分隔鍵插入 node
+    void splitOversized(BTreeNode* node, int i) {
+        HW6_COUNT(splitChild);
+        BTreeNode* y = own(node->children[i]);
+        int keyCount = static_cast<int>(y->keys.size());
+        std::vector<int> sizes = planNodeSizes(keyCount + 1, t, 2 * t, 2 * t); // 依子節點數分組，同 bulkLoad
+
+        std::vector<int> keys = std::move(y->keys);
+        std::vector<BTreeNode*> children;
+        if (!y->leaf) children.assign(y->children.begin(), y->children.begin() + keyCount + 1);
+
+        std::vector<int> separators;
+        std::vector<BTreeNode*> pieces;
+        size_t pos = 0;
+        for (size_t g = 0; g < sizes.size(); g++) {
+            BTreeNode* piece = g == 0 ? y : pool.create(t, y->leaf);
+            piece->keys.assign(keys.begin() + pos, keys.begin() + pos + sizes[g] - 1);
+            piece->children.assign(2 * t, nullptr);
+            if (!piece->leaf) std::copy(children.begin() + pos, children.begin() + pos + sizes[g], piece->children.begin());
+            pos += sizes[g];
+            if (g + 1 < sizes.size()) separators.push_back(keys[pos - 1]);
+            if (g > 0) pieces.push_back(piece);
+            if (orderStatistics) recount(piece);
+        }
+
+        fitChildren(node);
+        node->keys.insert(node->keys.begin() + i, separators.begin(), separators.end());
+        node->children.insert(node->children.begin() + i + 1, pieces.begin(), pieces.end());
+        fitChildren(node);
+    }
+
+    // 將已排序的 [first, last) 插入以 node 為根的子樹：依分隔鍵切分後每個節點只走訪一次，
+    // 葉節點一次合併整段鍵值，超出上限的子節點在返回時一次切開 (node 本身交由父節點處理)
+    void insertBatch(BTreeNode* node, const int* first, const int* last) {
+        HW6_COUNT(nodesVisited);
+        if (node->leaf) { // 由後往前就地合併，不需額外緩衝區
+            int i = static_cast<int>(node->keys.size()) - 1;
+            node->keys.resize(node->keys.size() + (last - first));
+            for (int out = static_cast<int>(node->keys.size()) - 1; last != first; out--) {
+                if (i >= 0 && node->keys[i] > *(last - 1)) node->keys[out] = node->keys[i--];
+                else node->keys[out] = *--last;
+            }
+            if (orderStatistics) recount(node);
+            return;
+        }
+
+        // 與 insertNonFull 相同：鍵值進入第一個大於它的分隔鍵左邊的子節點
+        // 由右往左處理，分裂第 i 個子節點只會移動 i 之後的分隔鍵，不影響尚未處理的部分
+        const int* hi = last;
+        for (int i = static_cast<int>(node->keys.size()); i >= 0 && hi != first; i--) {
+            const int* lo = i > 0 ? std::lower_bound(first, hi, node->keys[i - 1]) : first;
+            if (lo == hi) continue;
+            insertBatch(own(node->children[i]), lo, hi);
+            if (static_cast<int>(node->children[i]->keys.size()) > 2 * t - 1) {
+                splitOversized(node, i);
+            }
+            hi = lo;
+        }
+        if (orderStatistics) recount(node);
+    }
+
+    // 子樹中是否還有鍵值 (批次刪除後可能只剩沒有鍵值的節點鏈)
+    static bool hasKeys(const BTreeNode* node) {
+        while (node->keys.empty() && !node->leaf) node = node->children[0];
+        return !node->keys.empty();
+    }
+
+    // 合併第 idx 個子節點、父節點鍵值與右兄弟，節點大小不設限 (之後由 rebalance 處理)
+    void mergeUnbounded(BTreeNode* node, int idx) {
+        HW6_COUNT(merge);
+        BTreeNode* child = own(node->children[idx]);
+        BTreeNode* sibling = node->children[idx + 1];
+        child->children.resize(std::max<size_t>(2 * t, child->keys.size() + sibling->keys.size() + 2), nullptr); // 容納兩邊的子節點
+        merge(node, idx);
+    }
+
+    // 讓 node 的每個子節點都有 t-1 ~ 2t-1 個鍵值；子節點本身可以不足或超出，
+    // 其下層若只有沒有鍵值的節點鏈 (批次刪除造成) 也會在合併時一併修正
+    void rebalance(BTreeNode* node) {
+        int i = 0;
+        while (node->keys.size() > 0 && i <= static_cast<int>(node->keys.size())) {
+            BTreeNode* child = node->children[i];
+            int size = static_cast<int>(child->keys.size());
+            if (size > 2 * t - 1) {
+                splitOversized(node, i);
+                continue;
+            }
+            if (size >= t - 1) {
+                i++;
+                continue;
+            }
+
+            int j = i < static_cast<int>(node->keys.size()) ? i : i - 1; // 與右兄弟合併，最後一個則與左兄弟合併
+            mergeUnbounded(node, j);
+            if (!node->children[j]->leaf) rebalance(node->children[j]); // 接縫處的孫節點可能不足
+            i = j; // 重新檢查合併後的節點 (可能仍不足或已超出上限)
+        }
+        if (node->keys.empty() && !node->leaf) { // 只剩一個子節點時，交由上一層合併處理
+            BTreeNode* only = node->children[0];
+            if (static_cast<int>(only->keys.size()) > 2 * t - 1) splitOversized(node, 0);
+        }
+        fitChildren(node); // 合併後多出的子節點欄位收回，恢復為 2t 個 (仍超出上限時交由父節點切開)
+    }
+
+    // 移除並回傳子樹的最大鍵值，路徑上不足的節點由 rebalance 修正
+    int popMax(BTreeNode* node) {
+        if (node->leaf) {
+            int key = node->keys.back();
+            node->keys.pop_back();
+            if (orderStatistics) node->subtreeSize--;
+            return key;
+        }
+        int key = popMax(own(node->children[node->keys.size()]));
+        rebalance(node);
+        if (orderStatistics) recount(node);
+        return key;
+    }
+
+    // 移除並回傳子樹的最小鍵值
+    int popMin(BTreeNode* node) {
+        if (node->leaf) {
+            int key = node->keys.front();
+            node->keys.erase(node->keys.begin());
+            if (orderStatistics) node->subtreeSize--;
+            return key;
+        }
+        int key = popMin(own(node->children[0]));
+        rebalance(node);
+        if (orderStatistics) recount(node);
+        return key;
+    }
+
+    // 從以 node 為根的子樹刪除已排序且不重複的 [first, last)，回傳實際刪除的個數：
+    // 先依分隔鍵切分並遞迴到子節點，葉節點一次刪除整段，返回時再一併合併或借用
+    size_t removeBatch(BTreeNode* node, const int* first, const int* last) {
+        HW6_COUNT(nodesVisited);
+        if (node->leaf) { // 兩個已排序序列就地做差集，每個批次鍵值最多刪除一個相同的鍵值
+            size_t before = node->keys.size(), out = 0;
+            for (size_t i = 0; i < before; i++) {
+                while (first != last && *first < node->keys[i]) ++first;
+                if (first != last && *first == node->keys[i]) ++first;
+                else node->keys[out++] = node->keys[i];
+            }
+            node->keys.resize(out);
+            if (orderStatistics) recount(node);
+            return before - out;
+        }
+
+        // 子節點 i 負責 (keys[i-1], keys[i]) 之間的鍵值；等於分隔鍵的鍵值留在本節點處理
+        int n = static_cast<int>(node->keys.size());
+        size_t removed = 0;
+        const int* lo = first;
+        for (int i = 0; i <= n && lo != last; i++) {
+            const int* hi = i < n ? std::lower_bound(lo, last, node->keys[i]) : last;
+            if (lo != hi) removed += removeBatch(own(node->children[i]), lo, hi);
+            lo = (i < n && hi != last && *hi == node->keys[i]) ? hi + 1 : hi;
+        }
+
+        for (int i = n - 1; i >= 0; i--) { // 由右往左替換被刪除的內部鍵值 (左邊的鍵值不會因此移動)
+            bool firstOfEqual = i == 0 || node->keys[i - 1] != node->keys[i]; // 重複的分隔鍵只刪除最左邊的一個
+            if (!firstOfEqual || !std::binary_search(first, last, node->keys[i])) continue;
+            removed++;
+            if (hasKeys(node->children[i])) {
+                node->keys[i] = popMax(own(node->children[i])); // 以前驅取代
+            }
+            else if (hasKeys(node->children[i + 1])) {
+                node->keys[i] = popMin(own(node->children[i + 1])); // 以後繼取代
+            }
+            else { // 兩邊都已清空，直接丟掉右邊的子樹 (仍被快照共用的節點會保留)
+                release(node->children[i + 1], false);
+                node->keys.erase(node->keys.begin() + i);
+                node->children.erase(node->children.begin() + i + 1);
+                fitChildren(node);
+            }
+        }
+
+        rebalance(node);
+        if (orderStatistics) recount(node);
+        return removed;
+    }
+
+    // 把 node 的所有子節點 (連同其間的分隔鍵) 依序重新均分成較少的節點，讓每個節點接近 target 個鍵值，
+    // node 本身只剩新的分隔鍵 (非根節點至少保留 t-1 個鍵值)。沿用最左邊的幾個子節點，其餘的歸還 pool，回傳釋放的節點數
+    size_t packChildren(BTreeNode* node, int target, bool isRoot) {
+        int count = static_cast<int>(node->keys.size()) + 1;
+        int items = 0; // 所有子節點的「子節點欄位」總數，即鍵值與分隔鍵的總數加一
+        for (int i = 0; i < count; i++) items += static_cast<int>(node->children[i]->keys.size()) + 1;
+        int groups = std::min(count, std::max((items + target) / (target + 1), isRoot ? 1 : t));
+        if (groups >= count) return 0;
+
+        bool leaf = node->children[0]->leaf;
+        std::vector<int> keys;
+        std::vector<BTreeNode*> below;
+        keys.reserve(items);
+        for (int i = 0; i < count; i++) {
+            BTreeNode* child = own(node->children[i]);
+            keys.insert(keys.end(), child->keys.begin(), child->keys.end());
+            if (!leaf) below.insert(below.end(), child->children.begin(), child->children.begin() + child->keys.size() + 1);
+            if (i + 1 < count) keys.push_back(node->keys[i]);
+        }
+
+        node->keys.clear();
+        size_t next = 0, nextChild = 0;
+        for (int g = 0; g < groups; g++) {
+            int size = items / groups + (g < items % groups ? 1 : 0); // 這個節點的子節點欄位數
+            BTreeNode* child = node->children[g];
+            child->keys.assign(keys.begin() + next, keys.begin() + next + size - 1);
+            next += size - 1;
+            if (!leaf) {
+                std::fill(child->children.begin(), child->children.end(), nullptr);
+                std::copy(below.begin() + nextChild, below.begin() + nextChild + size, child->children.begin());
+                nextChild += size;
+            }
+            if (g + 1 < groups) node->keys.push_back(keys[next++]);
+            if (orderStatistics) recount(child);
+        }
+        for (int i = groups; i < count; i++) {
+            pool.destroy(node->children[i]);
+            node->children[i] = nullptr;
+        }
+        HW6_COUNT_N(merge, count - groups);
+        return count - groups;
+    }
+
+    // 以前序走訪 node 子樹中 compactCursor 之後的部分：先重新分配 node 的子節點 (讓它們各自有較多的子節點)，再往下處理每個子節點，
+    // 每重新分配一個子節點消耗一單位 budget。budget 用完時回傳 false，下次由 compactCursor 右邊的子樹繼續；
+    // 每次呼叫至少會處理到一個最底層的內部節點 (progressed)，不會停滯
+    bool compactSubtree(BTreeNode* node, bool isRoot, int target, size_t& budget, size_t& freed, bool& progressed) {
+        budget -= std::min(budget, node->keys.size() + 1);
+        freed += packChildren(node, target, isRoot);
+        if (node->children[0]->leaf) {
+            progressed = true;
+            return true;
+        }
+        int n = static_cast<int>(node->keys.size());
+        int i = static_cast<int>(std::upper_bound(node->keys.begin(), node->keys.end(), compactCursor) - node->keys.begin());
+        for (; i <= n; i++) {
+            if (budget == 0 && progressed) return false;
+            if (!compactSubtree(own(node->children[i]), false, target, budget, freed, progressed)) return false;
+            if (i < n) compactCursor = node->keys[i]; // 第 i 個子樹已處理完
+        }
+        return true;
+    }
+
+    // 由已排序的鍵值逐層往上建樹 (bulkLoad 與 parallelBulkLoad 共用)；
+    // 每一層都是「子節點 - 分隔鍵 - 子節點 ...」的序列，葉層的子節點皆為空指標，不另外存放。
+    // 同一層的節點互不相干：先依序向 pool 取得節點 (pool 不是執行緒安全的)，再由 workers 平行填入內容
+    void buildFromSorted(std::vector<int> separators, double fillFactor, ThreadPool* workers) {
+        clear(); // 取代原本的樹
+        if (separators.empty()) return;
+
+        // 非根節點有 t ~ 2t 個子節點，即 t-1 ~ 2t-1 個鍵值
+        int targetChildren = targetKeyCount(fillFactor, t - 1, 2 * t - 1) + 1;
+        std::vector<BTreeNode*> level;
+        size_t items = separators.size() + 1;
+        bool leaf = true;
+
+        while (true) {
+            std::vector<int> sizes = planNodeSizes(static_cast<int>(items), t, 2 * t, targetChildren);
+            std::vector<size_t> offsets(sizes.size(), 0);
+            for (size_t g = 1; g < sizes.size(); g++) offsets[g] = offsets[g - 1] + sizes[g - 1];
+
+            std::vector<BTreeNode*> parents(sizes.size());
+            for (BTreeNode*& node : parents) node = pool.create(t, leaf);
+            std::vector<int> parentSeparators(sizes.size() - 1);
+
+            auto buildNodes = [&](size_t first, size_t last) {
+                for (size_t g = first; g < last; g++) {
+                    BTreeNode* node = parents[g];
+                    size_t pos = offsets[g];
+                    node->keys.assign(separators.begin() + pos, separators.begin() + pos + sizes[g] - 1);
+                    if (!leaf) {
+                        std::copy(level.begin() + pos, level.begin() + pos + sizes[g], node->children.begin());
+                    }
+                    if (g + 1 < sizes.size()) parentSeparators[g] = separators[pos + sizes[g] - 1]; // 組與組之間的鍵值上移
+                    if (orderStatistics) recount(node); // 下一層已經計算完成
+                }
+            };
+            if (workers) parallelFor(0, parents.size(), std::max<size_t>(64, parents.size() / (workers->size() * 8)), buildNodes, *workers);
+            else buildNodes(0, parents.size());
+
+            if (parents.size() == 1) {
+                root = parents[0];
+                return;
+            }
+            items = parents.size();
+            level = std::move(parents);
+            separators = std::move(parentSeparators);
+            leaf = false;
+        }
+    }
+
+public:
+    // 初始化 B-tree；orderStatistics 為 true 時額外維護子樹大小，支援 rank / select / countRange
+    BTree(int t, bool orderStatistics = false) : root(nullptr), t(t), orderStatistics(orderStatistics) {}
+
+    // 節點由 pool 擁有，解構時隨 pool 一併釋放；所有 Snapshot 必須在此之前釋放
+    ~BTree() = default;
+    BTree(const BTree&) = delete;
+    BTree& operator=(const BTree&) = delete;
+
+    // 唯讀版本：由 snapshot() 取得，內容不再隨之後的寫入改變。
+    // 與樹共用所有未被修改的節點；可複製 (O(1))、可在其他執行緒讀取與釋放，但必須在 BTree 解構前釋放
+    class Snapshot {
+        friend class BTree;
+        BTree* tree = nullptr;
+        BTreeNode* root = nullptr;
+        bool orderStatistics = false; // 取得快照時樹是否維護子樹大小
+
+        Snapshot(BTree* tree, BTreeNode* root, bool orderStatistics) : tree(tree), root(root), orderStatistics(orderStatistics) {
+            if (!tree) return;
+            tree->liveSnapshots.fetch_add(1, std::memory_order_relaxed);
+            if (root) root->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+    public:
+        Snapshot() = default;
+        Snapshot(const Snapshot& other) : Snapshot(other.tree, other.root, other.orderStatistics) {}
+        Snapshot(Snapshot&& other) noexcept
+            : tree(std::exchange(other.tree, nullptr)), root(std::exchange(other.root, nullptr)), orderStatistics(other.orderStatistics) {}
+
+        Snapshot& operator=(Snapshot other) noexcept {
+            std::swap(tree, other.tree);
+            std::swap(root, other.root);
+            std::swap(orderStatistics, other.orderStatistics);
+            return *this;
+        }
+
+        ~Snapshot() {
+            reset();
+        }
+
+        // 放棄這個版本；只被此版本參考的節點交由樹在下一次寫入時回收
+        void reset() {
+            if (!tree) return;
+            if (root) tree->release(root, true);
+            tree->liveSnapshots.fetch_sub(1, std::memory_order_release);
+            tree = nullptr;
+            root = nullptr;
+        }
+
+        bool empty() const {
+            return !root;
+        }
+
+        const int* find(int k) const {
+            const BTreeNode* node = root;
+            while (node) {
+                int n = static_cast<int>(node->keys.size());
+                int i = nodesearch::rank(node->keys.data(), n, k);
+                if (i < n && node->keys[i] == k) return &node->keys[i];
+                if (node->leaf) return nullptr;
+                node = node->children[i];
+            }
+            return nullptr;
+        }
+
+        bool contains(int k) const {
+            return find(k) != nullptr;
+        }
+
+        int height() const {
+            int levels = 0;
+            for (const BTreeNode* node = root; node; node = node->leaf ? nullptr : node->children[0]) levels++;
+            return levels;
+        }
+
+        // 以下與 BTree 的同名查詢相同，需在取得快照時已啟用 order statistics
+        size_t size() const {
+            requireOrderStatistics(orderStatistics);
+            return root ? root->subtreeSize : 0;
+        }
+
+        size_t rank(int k) const {
+            requireOrderStatistics(orderStatistics);
+            return countBelow(root, k, false);
+        }
+
+        const int* select(size_t k) const {
+            requireOrderStatistics(orderStatistics);
+            return BTree::select(root, k);
+        }
+
+        size_t countRange(int lo, int hi) const {
+            requireOrderStatistics(orderStatistics);
+            if (lo > hi) return 0;
+            return countBelow(root, hi, true) - countBelow(root, lo, false);
+        }
+
+        template <typename Fn>
+        void forEachInRange(int lo, int hi, Fn fn) const {
+            if (root && lo <= hi) BTree::forEachInRange(root, lo, hi, fn);
+        }
+
+        template <typename T, typename Map, typename Combine>
+        T reduceRange(int lo, int hi, T identity, Map map, Combine combine) const {
+            if (!root || lo > hi) return identity;
+            return BTree::reduceRange(root, lo, hi, identity, map, combine, nullptr, 0);
+        }
+    };
+
+    // 取得目前版本的快照：只增加根節點的參考數，O(1) (處於遞增插入模式時先花 O(t height) 結束該模式)。
+    // 之後的寫入遇到被共用的節點時才複製，每次寫入最多複製根到葉路徑上 (以及合併或借用時的兄弟) 的 O(height) 個節點
+    Snapshot snapshot() {
+        reclaim();
+        sealSpine();
+        return Snapshot(this, root, orderStatistics);
+    }
+
+    // 目前尚未釋放的快照個數
+    size_t snapshotCount() const {
+        return liveSnapshots.load(std::memory_order_acquire);
+    }
+
+    // 清空整棵樹：沒有快照時直接重置 pool，不需逐一走訪節點；否則只釋放不再被快照共用的節點
+    void clear() {
+        spine.clear();
+        if (filter) filter->clear();
+        filterStale = 0;
+        if (liveSnapshots.load(std::memory_order_acquire) > 0) {
+            reclaim();
+            if (root) release(root, false);
+            root = nullptr;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(retiredLock);
+            retired.clear(); // 這些節點隨 pool 一併回收
+            hasRetired.store(false, std::memory_order_relaxed);
+        }
+        root = nullptr;
+        pool.reset();
+    }
+
+    // 由下而上批次建樹：輸入不需事先排序，已排序時省略排序步驟
+    // fillFactor 為每個節點的目標填充率 (0~1]，所有節點一次建好，不經過 insertNonFull / splitChild
+    template <typename InputIt>
+    void bulkLoad(InputIt first, InputIt last, double fillFactor = 1.0) {
+        std::vector<int> keys(first, last);
+        if (!std::is_sorted(keys.begin(), keys.end())) {
+            std::sort(keys.begin(), keys.end());
+        }
+        buildFromSorted(std::move(keys), fillFactor, nullptr);
+        rebuildFilter();
+    }
+
+    // 平行版的 bulkLoad：以 workers 平行排序，再平行填入每一層節點的鍵值與子節點
+    template <typename InputIt>
+    void parallelBulkLoad(InputIt first, InputIt last, ThreadPool& workers, double fillFactor = 1.0) {
+        std::vector<int> keys(first, last);
+        parallelSort(keys, workers);
+        buildFromSorted(std::move(keys), fillFactor, &workers);
+        rebuildFilter();
+    }
+
+    // 將目前的鍵值凍結成唯讀的 FrozenIndex (Eytzinger 順序的連續陣列)，之後對樹的修改不影響它
+    FrozenIndex freeze() const {
+        std::vector<int> keys;
+        if (orderStatistics) keys.reserve(size());
+        forEachInRange(INT32_MIN, INT32_MAX, [&](int key) { keys.push_back(key); });
+        return FrozenIndex(keys.begin(), keys.end());
+    }
+
+    // 將整棵樹以二進位快照寫入檔案，成功時回傳 true (處於遞增插入模式時先結束該模式，檔案中的節點才都至少有 t-1 個鍵值)
+    bool saveSnapshot(const std::string& path) {
+        reclaim();
+        sealSpine();
+        return snapshot::save(path, snapshot::Kind::BTree, t, root, [](const BTreeNode* node) { return node->leaf; });
+    }
+
+    // 由快照檔還原整棵樹 (最小度數改為快照中的值)，節點直接依層序重建，不經過任何分裂
+    // 檔案不存在或格式錯誤時回傳 false，樹保持為空
+    bool loadSnapshot(const std::string& path) {
+        std::vector<char> data;
+        snapshot::Header header;
+        clear();
+        if (!snapshot::readFile(path, data) || !snapshot::readHeader(data, snapshot::Kind::BTree, header)) return false;
+        if (header.degree < 2 || header.degree > snapshot::kMaxDegree) return false;
+        t = static_cast<int>(header.degree);
+        bool ok = snapshot::load<BTreeNode>(data, header, t - 1, 2 * t - 1, [&](bool leaf) { return pool.create(t, leaf); }, root);
+        if (!ok) clear();
+        if (ok && root && orderStatistics) recountAll(root);
+        rebuildFilter();
+        return ok;
+    }
+
+    // 插入鍵值；不小於目前最大值的鍵值 (遞增的時間戳記等) 直接接在最右葉節點，均攤 O(1)
+    void insert(int k) {
+        HW6_COUNT(operations);
+        reclaim();
+        filterAdd(k); // 途中重建時 k 還不在樹上，因此重建後才加入
+        if (!spine.empty()) {
+            if (k >= spine.back()->keys.back()) {
+                appendToSpine(k);
+                return;
+            }
+            sealSpine();
+        }
+        if (!root) {
+            root = pool.create(t, true); // 如果根節點為空，創建根節點
+            root->keys.push_back(k); // 插入鍵值
+            root->subtreeSize = 1;
+            return;
+        }
+
+        own(root); // 之後的寫入都由根節點往下，路徑上仍被快照共用的節點會先複製
+        if (static_cast<int>(root->keys.size()) == 2 * t - 1) { // 如果根節點滿
+            BTreeNode* newRoot = pool.create(t, false); // 創建新根節點
+            newRoot->children[0] = root; // 將舊根節點設為新根的子節點
+            newRoot->subtreeSize = root->subtreeSize;
+            splitChild(newRoot, 0); // 分裂根節點
+            root = newRoot; // 更新根節點
+        }
+
+        if (insertNonFull(root, k)) buildSpine(); // 插入鍵值；k 成為最大值時進入遞增插入模式
+    }
+
+    // 批次插入：排序後由根節點一路切分到葉節點，每個節點只走訪一次
+    void insertBatch(std::span<const int> batch) {
+        HW6_COUNT_N(operations, batch.size());
+        if (batch.empty()) return;
+        std::vector<int> sorted(batch.begin(), batch.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        reclaim();
+        sealSpine();
+        if (!root) root = pool.create(t, true);
+        insertBatch(own(root), sorted.data(), sorted.data() + sorted.size());
+
+        while (static_cast<int>(root->keys.size()) > 2 * t - 1) { // 根節點超出上限時往上長高
+            BTreeNode* newRoot = pool.create(t, false);
+            newRoot->children[0] = root;
+            root = newRoot;
+            splitOversized(root, 0);
+            if (orderStatistics) recount(root);
+        }
+        for (int k : sorted) filterAdd(k); // 鍵值都已在樹上，途中重建也不會遺漏
+    }
+
+    // 批次刪除，與逐一呼叫 remove 相同，每個不同的鍵值刪除一個；回傳實際刪除的鍵值數，不存在的鍵值直接略過
+    size_t removeBatch(std::span<const int> batch) {
+        HW6_COUNT_N(operations, batch.size());
+        if (!root || batch.empty()) return 0;
+        std::vector<int> sorted(batch.begin(), batch.end());
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end()); // 去除重複，每個鍵值只會落在一個位置
+        if (filter) { // filter 排除的鍵值一定不存在，不必往下切分
+            sorted.erase(std::remove_if(sorted.begin(), sorted.end(), [&](int k) { return !filter->mayContain(k); }), sorted.end());
+            if (sorted.empty()) return 0;
+        }
+
+        reclaim();
+        sealSpine();
+        size_t removed = removeBatch(own(root), sorted.data(), sorted.data() + sorted.size());
+
+        while (root->keys.empty() && !root->leaf) { // 根節點已空，樹高減一
+            BTreeNode* tmp = own(root); // 子節點的參考移交給 root
+            root = root->children[0];
+            pool.destroy(tmp);
+        }
+        if (root->keys.size() > 2 * static_cast<size_t>(t) - 1) { // 根節點的子節點合併後可能超出上限
+            BTreeNode* newRoot = pool.create(t, false);
+            newRoot->children[0] = root;
+            root = newRoot;
+            splitOversized(root, 0);
+            if (orderStatistics) recount(root);
+        }
+        if (root->keys.empty() && root->leaf) {
+            release(root, false);
+            root = nullptr;
+        }
+        filterRemoved(removed);
+        return removed;
+    }
+
+    // 刪除鍵值：先以唯讀的搜尋確認鍵值存在 (啟用 membership filter 時多數不存在的鍵值不必走訪樹)，
+    // 不存在的鍵值不會合併、借用或複製任何節點，也不會結束遞增插入模式
+    void remove(int k) {
+        HW6_COUNT(operations);
+        if (!root) return;
+        if (!locate(k)) {
+            bool rejected = filter && !filter->mayContain(k); // filter 排除的鍵值沒有走訪樹，也不輸出訊息
+            if (reportMissing && !rejected) std::cout << "Key " << k << " not found in the tree.\n";
+            return;
+        }
+        reclaim();
+        sealSpine();
+
+        remove(own(root), k); // 遞迴刪除鍵值
+        filterRemoved(1);
+
+        if (root->keys.empty()) { // 如果根節點鍵值數為空
+            BTreeNode* tmp = root;
+            if (root->leaf) { // 如果根節點是葉節點
+                root = nullptr; // 樹變為空
+            }
+            else {
+                root = root->children[0]; // 根節點下移
+            }
+            pool.destroy(tmp); // 釋放舊根節點
+        }
+    }
+
+    // 查詢鍵值，找到時回傳指向該鍵值的指標，否則回傳 nullptr；不會修改樹
+    const int* find(int k) const {
+        HW6_COUNT(operations);
+        return locate(k);
+    }
+
+    // 判斷鍵值是否存在
+    bool contains(int k) const {
+        return find(k) != nullptr;
+    }
+
+    // 樹高 (空樹為 0，只有根節點時為 1)
+    int height() const {
+        int levels = 0;
+        for (const BTreeNode* node = root; node; node = node->leaf ? nullptr : node->children[0]) levels++;
+        return levels;
+    }
+
+    // 結構操作計數 (定義 HW6_NO_STATS 時恆為 0)
+    const OpStats& opStats() const {
+        return stats;
+    }
+
+    void resetOpStats() {
+        stats = OpStats();
+    }
+
+    // 樹高、節點數、每層填充率與節點佔用的記憶體
+    ShapeStats shapeStats() const {
+        return computeShape(root, 2 * t - 1, [](const BTreeNode* node) { return node->leaf; });
+    }
+
+    // 樹上節點與 pool 中閒置節點佔用的記憶體，以及整棵樹的填充率；需走訪所有節點
+    MemoryUsage memoryUsage() const {
+        return computeMemory(shapeStats(), pool);
+    }
+
+    // 線上壓縮：先釋放 pool 中閒置節點的 keys / children 緩衝區，再由上而下、由左往右把同一個父節點下的子節點重新均分成
+    // 較少的節點，讓節點接近 fillFactor (與 bulkLoad 相同) 的填充率，根節點的子節點全部合併時樹高減一。
+    // 每次呼叫最多處理約 budget 個節點後返回，可在兩個請求之間分次執行 (搭配 compactionPending)；回傳這次從樹上釋放的節點數
+    size_t compact(size_t budget, double fillFactor = 1.0) {
+        reclaim();
+        sealSpine();
+        budget -= pool.releaseIdle(budget, [](BTreeNode* node) {
+            std::vector<int>().swap(node->keys);
+            std::vector<BTreeNode*>().swap(node->children);
+        });
+        if (!root || budget == 0) return 0;
+        if (!compacting) compactCursor = INT32_MIN; // 新的一輪由最左邊開始
+        compacting = true;
+        size_t freed = 0;
+        bool progressed = false;
+        int target = targetKeyCount(fillFactor, t - 1, 2 * t - 1);
+        if (root->leaf || compactSubtree(own(root), true, target, budget, freed, progressed)) {
+            compacting = false; // 這一輪完成
+        }
+        while (root->keys.empty() && !root->leaf) { // 根節點的子節點全部合併，樹高減一
+            BTreeNode* tmp = root;
+            root = root->children[0];
+            pool.destroy(tmp);
+            freed++;
+        }
+        return freed;
+    }
+
+    // 是否還有 compact 可做的事：一輪尚未完成，或 pool 中還有沒釋放緩衝區的閒置節點
+    bool compactionPending() const {
+        return compacting || pool.hasUnreleasedIdle();
+    }
+
+    // 刪除不存在的鍵值時是否輸出 "Key ... not found" (預設輸出)；批次執行指令或量測時關閉，避免輸出成為主要成本
+    void setReportMissing(bool enabled) {
+        reportMissing = enabled;
+    }
+
+    // 啟用 membership filter (分塊 Bloom filter，約 bitsPerKey 位元/鍵值並預留一倍給之後的插入)：
+    // find / contains / remove / removeBatch 先查詢 filter，多數不存在的鍵值不必走訪樹。
+    // 刪除的鍵值無法從 filter 移除，過時的鍵值過多或插入超出容量時自動以 O(n) 重建，均攤 O(1)
+    void enableMembershipFilter(double bitsPerKey = 10) {
+        filterBitsPerKey = std::max(bitsPerKey, 1.0);
+        filter.emplace();
+        rebuildFilter();
+    }
+
+    void disableMembershipFilter() {
+        filter.reset();
+        filterStale = 0;
+    }
+
+    bool hasMembershipFilter() const {
+        return filter.has_value();
+    }
+
+    // membership filter 佔用的位元組數 (未啟用時為 0)
+    size_t membershipFilterBytes() const {
+        return filter ? filter->memoryBytes() : 0;
+    }
+
+    // 在既有的樹上啟用 order statistics：由下而上計算一次所有節點的子樹大小
+    void enableOrderStatistics() {
+        if (orderStatistics) return;
+        orderStatistics = true;
+        if (root) recountAll(root);
+    }
+
+    bool hasOrderStatistics() const {
+        return orderStatistics;
+    }
+
+    // 以下查詢需要啟用 order statistics，否則擲出 std::logic_error；每層只看一個節點，時間為 O(t log n)
+
+    // 鍵值總數
+    size_t size() const {
+        requireOrderStatistics(orderStatistics);
+        return root ? root->subtreeSize : 0;
+    }
+
+    // 小於 k 的鍵值個數
+    size_t rank(int k) const {
+        requireOrderStatistics(orderStatistics);
+        return countBelow(root, k, false);
+    }
+
+    // 第 k 小的鍵值 (由 0 起算)，k 超出範圍時回傳 nullptr
+    const int* select(size_t k) const {
+        requireOrderStatistics(orderStatistics);
+        return select(root, k);
+    }
+
+    // [lo, hi] 內的鍵值個數
+    size_t countRange(int lo, int hi) const {
+        requireOrderStatistics(orderStatistics);
+        if (lo > hi) return 0;
+        return countBelow(root, hi, true) - countBelow(root, lo, false);
+    }
+
+    // 依序對 [lo, hi] 內的每個鍵值呼叫 fn，只走訪與區間重疊的子樹
+    template <typename Fn>
+    void forEachInRange(int lo, int hi, Fn fn) const {
+        if (root && lo <= hi) forEachInRange(root, lo, hi, fn);
+    }
+
+    // 中序走訪 node 子樹內落在 [lo, hi] 的鍵值；遇到大於 hi 的鍵值時回傳 false 表示可以停止
+    template <typename Fn>
+    static bool forEachInRange(const BTreeNode* node, int lo, int hi, Fn& fn) {
+        bool leaf = node->leaf;
+        int n = static_cast<int>(node->keys.size());
+        for (int i = nodesearch::rank(node->keys.data(), n, lo); i < n; i++) {
+            if (!leaf && !forEachInRange(node->children[i], lo, hi, fn)) return false;
+            if (node->keys[i] > hi) return false;
+            fn(node->keys[i]);
+        }
+        return leaf || forEachInRange(node->children[n], lo, hi, fn);
+    }
+
+    // 平行版 forEachInRange：從根節點開始把與 [lo, hi] 重疊的子樹分給 workers，
+    // fn 會在多個執行緒上同時被呼叫 (需為執行緒安全)，呼叫順序不固定
+    template <typename Fn>
+    void parallelForEachInRange(int lo, int hi, Fn fn, ThreadPool& workers) const {
+        if (root && lo <= hi) parallelForEachInRange(root, lo, hi, fn, workers, spawnLevels(workers));
+    }
+
+    // 對 [lo, hi] 內的每個鍵值計算 map(key)，再依鍵值順序以 combine 合併；
+    // map 會在多個執行緒上同時被呼叫，combine 需滿足結合律，identity 為其單位元
+    template <typename T, typename Map, typename Combine>
+    T parallelReduceRange(int lo, int hi, T identity, Map map, Combine combine, ThreadPool& workers) const {
+        if (!root || lo > hi) return identity;
+        return reduceRange(root, lo, hi, identity, map, combine, &workers, spawnLevels(workers));
+    }
+
+    // 循序版的 reduceRange，結果與 parallelReduceRange 相同
+    template <typename T, typename Map, typename Combine>
+    T reduceRange(int lo, int hi, T identity, Map map, Combine combine) const {
+        if (!root || lo > hi) return identity;
+        return reduceRange(root, lo, hi, identity, map, combine, nullptr, 0);
+    }
+
+private:
+    // 從根節點往下幾層內的子樹要分成獨立工作：讓工作數約為執行緒數的 8 倍
+    int spawnLevels(const ThreadPool& workers) const {
+        int levels = 0;
+        for (size_t tasks = 1; tasks < workers.size() * 8; tasks *= t) levels++;
+        return workers.size() > 1 ? levels : 0;
+    }
+
+    // node 中與 [lo, hi] 重疊的子節點為 children[first..last]，鍵值為 keys[first..last-1]
+    static void overlap(const BTreeNode* node, int lo, int hi, int& first, int& last) {
+        int n = static_cast<int>(node->keys.size());
+        first = nodesearch::rank(node->keys.data(), n, lo);
+        last = static_cast<int>(std::upper_bound(node->keys.begin() + first, node->keys.end(), hi) - node->keys.begin());
+    }
+
+    template <typename Fn>
+    static void parallelForEachInRange(const BTreeNode* node, int lo, int hi, Fn& fn, ThreadPool& workers, int levels) {
+        if (levels == 0 || node->leaf) {
+            forEachInRange(node, lo, hi, fn);
+            return;
+        }
+        int first, last;
+        overlap(node, lo, hi, first, last);
+        TaskGroup group(workers);
+        for (int i = first; i <= last; i++) {
+            group.run([&, i] { parallelForEachInRange(node->children[i], lo, hi, fn, workers, levels - 1); });
+        }
+        for (int i = first; i < last; i++) fn(node->keys[i]);
+        group.wait();
+    }
+
+    template <typename T, typename Map, typename Combine>
+    static T reduceRange(const BTreeNode* node, int lo, int hi, const T& identity, Map& map, Combine& combine, ThreadPool* workers, int levels) {
+        int first, last;
+        overlap(node, lo, hi, first, last);
+        T result = identity;
+        if (node->leaf) {
+            for (int i = first; i < last; i++) result = combine(result, map(node->keys[i]));
+            return result;
+        }
+        if (!workers || levels == 0) {
+            for (int i = first; i <= last; i++) {
+                result = combine(result, reduceRange(node->children[i], lo, hi, identity, map, combine, nullptr, 0));
+                if (i < last) result = combine(result, map(node->keys[i]));
+            }
+            return result;
+        }
+
+        struct Slot { T value; }; // 避免 std::vector<bool> 的位元打包造成多執行緒寫入衝突
+        std::vector<Slot> parts(last - first + 1, Slot{ identity });
+        TaskGroup group(*workers);
+        for (int i = first; i <= last; i++) {
+            group.run([&, i] { parts[i - first].value = reduceRange(node->children[i], lo, hi, identity, map, combine, workers, levels - 1); });
+        }
+        group.wait();
+        for (int i = first; i <= last; i++) { // 依鍵值順序合併
+            result = combine(result, parts[i - first].value);
+            if (i < last) result = combine(result, map(node->keys[i]));
+        }
+        return result;
+    }
+
+public:
+
+    // 打印整棵 B-tree：每個節點一行並依層次縮排，整棵樹寫入同一塊緩衝區後才輸出
+    void printTree() const {
+        render::printIndented(std::cout, root, [](const BTreeNode* node) { return node->leaf; });
+    }
+
+    // 逐層輸出 (每層一行)，limits 限制輸出的層數、每層的節點數與每個節點的鍵值數，適合檢視很大的樹
+    void printLevels(std::ostream& out, const render::Limits& limits = {}) const {
+        render::printLevels(out, root, [](const BTreeNode* node) { return node->leaf; }, limits);
+    }
+
+    // 匯出 Graphviz DOT (dot -Tsvg 可直接繪製)
+    void exportDot(std::ostream& out, const render::Limits& limits = {}) const {
+        render::writeDot(out, root, [](const BTreeNode* node) { return node->leaf; }, limits);
+    }
+
+    // 匯出巢狀的 JSON
+    void exportJson(std::ostream& out, const render::Limits& limits = {}) const {
+        render::writeJson(out, root, [](const BTreeNode* node) { return node->leaf; }, limits);
+    }
+};
@@ -0,0 +1,378 @@
+﻿#pragma once
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "NodeSearch.h"
+
+// 以 Key 排序、每個鍵值附帶一個 Value 的 B-tree (鍵值不重複)
+// 插入與刪除流程與 BTree 相同 (主動分裂、往下走之前先補足子節點)，
+// 分裂、合併與借用時 Value 一律以移動的方式搬動，因此可以存放 std::unique_ptr 等只能移動的型別；
+// Key 需可複製 (刪除內部節點的鍵值時以前驅的複本往下搜尋)
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class BTreeMap {
+    // 節點中 keys 與 values 分開存放，搜尋時只需掃過連續的 keys
+    struct Node {
+        std::vector<Key> keys;
+        std::vector<Value> values;
+        std::vector<Node*> children; // 內部節點有 keys.size()+1 個子節點，葉節點為空
+        bool leaf;
+
+        // 預留 2t-1 個空間，之後的 insert / erase 都不會重新配置，只會移動元素
+        Node(int t, bool leaf) : leaf(leaf) {
+            keys.reserve(2 * t - 1);
+            values.reserve(2 * t - 1);
+            if (!leaf) children.reserve(2 * t);
+        }
+    };
+
+    Node* root; // 樹的根節點
+    int t; // 最小度數
+    size_t count; // 鍵值總數
+    Compare comp;
+
+    bool equal(const Key& a, const Key& b) const {
+        return !comp(a, b) && !comp(b, a);
+    }
+
+    // 節點內第一個不小於 key 的位置；int 鍵值搭配 std::less 時使用 SIMD 搜尋
+    int lowerBound(const Node* node, const Key& key) const {
+        if constexpr (std::is_same_v<Key, int> && std::is_same_v<Compare, std::less<int>>) {
+            return nodesearch::rank(node->keys.data(), static_cast<int>(node->keys.size()), key);
+        }
+        else {
+            return static_cast<int>(std::lower_bound(node->keys.begin(), node->keys.end(), key, comp) - node->keys.begin());
+        }
+    }
+
+    // 遞迴釋放子樹
+    static void destroy(Node* node) {
+        if (!node) return;
+        for (Node* child : node->children) destroy(child);
+        delete node;
+    }
+
+    // 分裂已滿的子節點，右半部的鍵值與值以移動的方式搬到新節點
+    void splitChild(Node* node, int i) {
+        Node* y = node->children[i];
+        Node* z = new Node(t, y->leaf);
+
+        z->keys.assign(std::make_move_iterator(y->keys.begin() + t), std::make_move_iterator(y->keys.end()));
+        z->values.assign(std::make_move_iterator(y->values.begin() + t), std::make_move_iterator(y->values.end()));
+        if (!y->leaf) {
+            z->children.assign(y->children.begin() + t, y->children.end());
+            y->children.resize(t);
+        }
+
+        // 中間的鍵值上移到父節點
+        node->keys.insert(node->keys.begin() + i, std::move(y->keys[t - 1]));
+        node->values.insert(node->values.begin() + i, std::move(y->values[t - 1]));
+        node->children.insert(node->children.begin() + i + 1, z);
+        y->keys.erase(y->keys.begin() + (t - 1), y->keys.end());
+        y->values.erase(y->values.begin() + (t - 1), y->values.end());
+    }
+
+    // 插入或取代；鍵值已存在時回傳 false 並呼叫 assign(value)，否則以 make(values, position) 就地建立新值
+    template <typename K, typename Assign, typename Make>
+    std::pair<Value*, bool> insertNonFull(Node* node, K&& key, Assign&& assign, Make&& make) {
+        while (true) {
+            int i = lowerBound(node, key);
+            if (i < static_cast<int>(node->keys.size()) && equal(node->keys[i], key)) {
+                assign(node->values[i]);
+                return { &node->values[i], false };
+            }
+            if (node->leaf) {
+                node->keys.insert(node->keys.begin() + i, std::forward<K>(key));
+                make(node->values, node->values.begin() + i);
+                count++;
+                return { &node->values[i], true };
+            }
+            if (static_cast<int>(node->children[i]->keys.size()) == 2 * t - 1) { // 子節點已滿時先分裂
+                splitChild(node, i);
+                if (equal(node->keys[i], key)) { // 上移的中間鍵值正好是要找的鍵值
+                    assign(node->values[i]);
+                    return { &node->values[i], false };
+                }
+                if (comp(node->keys[i], key)) i++;
+            }
+            node = node->children[i];
+        }
+    }
+
+    template <typename K, typename Assign, typename Make>
+    std::pair<Value*, bool> insertImpl(K&& key, Assign&& assign, Make&& make) {
+        if (!root) root = new Node(t, true);
+        if (static_cast<int>(root->keys.size()) == 2 * t - 1) { // 根節點已滿時先分裂
+            Node* newRoot = new Node(t, false);
+            newRoot->children.push_back(root);
+            root = newRoot;
+            splitChild(root, 0);
+        }
+        return insertNonFull(root, std::forward<K>(key), assign, make);
+    }
+
+    // 從左兄弟借用鍵值
+    void borrowFromPrev(Node* node, int idx) {
+        Node* child = node->children[idx];
+        Node* sibling = node->children[idx - 1];
+
+        child->keys.insert(child->keys.begin(), std::move(node->keys[idx - 1]));
+        child->values.insert(child->values.begin(), std::move(node->values[idx - 1]));
+        if (!child->leaf) {
+            child->children.insert(child->children.begin(), sibling->children.back());
+            sibling->children.pop_back();
+        }
+
+        node->keys[idx - 1] = std::move(sibling->keys.back());
+        node->values[idx - 1] = std::move(sibling->values.back());
+        sibling->keys.pop_back();
+        sibling->values.pop_back();
+    }
+
+    // 從右兄弟借用鍵值
+    void borrowFromNext(Node* node, int idx) {
+        Node* child = node->children[idx];
+        Node* sibling = node->children[idx + 1];
+
+        child->keys.push_back(std::move(node->keys[idx]));
+        child->values.push_back(std::move(node->values[idx]));
+        if (!child->leaf) {
+            child->children.push_back(sibling->children.front());
+            sibling->children.erase(sibling->children.begin());
+        }
+
+        node->keys[idx] = std::move(sibling->keys.front());
+        node->values[idx] = std::move(sibling->values.front());
+        sibling->keys.erase(sibling->keys.begin());
+        sibling->values.erase(sibling->values.begin());
+    }
+
+    // 將 children[idx+1] 與分隔鍵值併入 children[idx]
+    void merge(Node* node, int idx) {
+        Node* child = node->children[idx];
+        Node* sibling = node->children[idx + 1];
+
+        child->keys.push_back(std::move(node->keys[idx]));
+        child->values.push_back(std::move(node->values[idx]));
+        child->keys.insert(child->keys.end(), std::make_move_iterator(sibling->keys.begin()), std::make_move_iterator(sibling->keys.end()));
+        child->values.insert(child->values.end(), std::make_move_iterator(sibling->values.begin()), std::make_move_iterator(sibling->values.end()));
+        if (!child->leaf) {
+            child->children.insert(child->children.end(), sibling->children.begin(), sibling->children.end());
+        }
+
+        node->keys.erase(node->keys.begin() + idx);
+        node->values.erase(node->values.begin() + idx);
+        node->children.erase(node->children.begin() + idx + 1);
+        sibling->children.clear();
+        delete sibling;
+    }
+
+    // 處理子節點鍵值數不足的情況
+    void fill(Node* node, int idx) {
+        if (idx != 0 && static_cast<int>(node->children[idx - 1]->keys.size()) >= t) {
+            borrowFromPrev(node, idx);
+        }
+        else if (idx != static_cast<int>(node->keys.size()) && static_cast<int>(node->children[idx + 1]->keys.size()) >= t) {
+            borrowFromNext(node, idx);
+        }
+        else if (idx != static_cast<int>(node->keys.size())) {
+            merge(node, idx);
+        }
+        else {
+            merge(node, idx - 1);
+        }
+    }
+
+    // 子樹中最大 / 最小鍵值所在的葉節點
+    static Node* rightmostLeaf(Node* node) {
+        while (!node->leaf) node = node->children.back();
+        return node;
+    }
+
+    static Node* leftmostLeaf(Node* node) {
+        while (!node->leaf) node = node->children.front();
+        return node;
+    }
+
+    // 從子樹中刪除鍵值 (同 BTree::remove)；內部節點的鍵值以前驅或後繼取代，值以移動的方式上移
+    bool remove(Node* node, const Key& key) {
+        while (true) {
+            int idx = lowerBound(node, key);
+            int n = static_cast<int>(node->keys.size());
+
+            if (idx < n && equal(node->keys[idx], key)) {
+                if (node->leaf) {
+                    node->keys.erase(node->keys.begin() + idx);
+                    node->values.erase(node->values.begin() + idx);
+                    return true;
+                }
+                if (static_cast<int>(node->children[idx]->keys.size()) >= t) {
+                    Node* pred = rightmostLeaf(node->children[idx]);
+                    node->keys[idx] = pred->keys.back();
+                    node->values[idx] = std::move(pred->values.back()); // 葉節點留下被移走的值，隨後刪除
+                    Key next = node->keys[idx];
+                    return remove(node->children[idx], next);
+                }
+                if (static_cast<int>(node->children[idx + 1]->keys.size()) >= t) {
+                    Node* succ = leftmostLeaf(node->children[idx + 1]);
+                    node->keys[idx] = succ->keys.front();
+                    node->values[idx] = std::move(succ->values.front());
+                    Key next = node->keys[idx];
+                    return remove(node->children[idx + 1], next);
+                }
+                merge(node, idx);
+                node = node->children[idx];
+                continue;
+            }
+
+            if (node->leaf) return false;
+            bool flag = (idx == n); // 是否在最後一個子節點中
+            if (static_cast<int>(node->children[idx]->keys.size()) < t) fill(node, idx);
+            node = (flag && idx > static_cast<int>(node->keys.size())) ? node->children[idx - 1] : node->children[idx];
+        }
+    }
+
+    const Node* findNode(const Key& key, int& index) const {
+        const Node* node = root;
+        while (node) {
+            int i = lowerBound(node, key);
+            if (i < static_cast<int>(node->keys.size()) && equal(node->keys[i], key)) {
+                index = i;
+                return node;
+            }
+            if (node->leaf) return nullptr;
+            node = node->children[i];
+        }
+        return nullptr;
+    }
+
+    template <typename Fn>
+    static void forEach(Node* node, Fn& fn) {
+        for (size_t i = 0; i < node->keys.size(); i++) {
+            if (!node->leaf) forEach(node->children[i], fn);
+            fn(static_cast<const Key&>(node->keys[i]), node->values[i]);
+        }
+        if (!node->leaf) forEach(node->children.back(), fn);
+    }
+
+    void printTree(const Node* node, int level) const {
+        std::cout << std::string(level * 4, ' '); // 根據層次增加縮排
+        for (const Key& key : node->keys) std::cout << key << " ";
+        std::cout << "\n";
+        for (const Node* child : node->children) printTree(child, level + 1);
+    }
+
+public:
+    explicit BTreeMap(int t, Compare comp = Compare()) : root(nullptr), t(t), count(0), comp(comp) {
+        if (t < 2) throw std::invalid_argument("BTreeMap 的最小度數至少為 2");
+    }
+
+    ~BTreeMap() {
+        destroy(root);
+    }
+
+    BTreeMap(const BTreeMap&) = delete;
+    BTreeMap& operator=(const BTreeMap&) = delete;
+
+    BTreeMap(BTreeMap&& other) noexcept : root(other.root), t(other.t), count(other.count), comp(std::move(other.comp)) {
+        other.root = nullptr;
+        other.count = 0;
+    }
+
+    BTreeMap& operator=(BTreeMap&& other) noexcept {
+        if (this != &other) {
+            destroy(root);
+            root = std::exchange(other.root, nullptr);
+            t = other.t;
+            count = std::exchange(other.count, 0);
+            comp = std::move(other.comp);
+        }
+        return *this;
+    }
+
+    // 清空整棵樹並解構所有值
+    void clear() {
+        destroy(root);
+        root = nullptr;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // 鍵值不存在時插入 value，存在時以 value 取代原本的值；second 為 true 表示新插入
+    template <typename K, typename V>
+    std::pair<Value*, bool> insert_or_assign(K&& key, V&& value) {
+        return insertImpl(std::forward<K>(key),
+            [&](Value& existing) { existing = std::forward<V>(value); },
+            [&](std::vector<Value>& values, auto position) { values.emplace(position, std::forward<V>(value)); });
+    }
+
+    // 鍵值不存在時以 args 就地建構新值，存在時不做任何事；second 為 true 表示新插入
+    template <typename K, typename... Args>
+    std::pair<Value*, bool> emplace(K&& key, Args&&... args) {
+        return insertImpl(std::forward<K>(key),
+            [](Value&) {},
+            [&](std::vector<Value>& values, auto position) { values.emplace(position, std::forward<Args>(args)...); });
+    }
+
+    // 刪除鍵值與其值，回傳是否真的刪除
+    bool erase(const Key& key) {
+        if (!root) return false;
+        bool removed = remove(root, key);
+        if (removed) count--;
+
+        if (root->keys.empty()) { // 根節點已空，樹高減一
+            Node* old = root;
+            root = root->leaf ? nullptr : root->children[0];
+            old->children.clear();
+            delete old;
+        }
+        return removed;
+    }
+
+    // 查詢鍵值，找到時回傳指向其值的指標，否則回傳 nullptr
+    Value* find(const Key& key) {
+        int index;
+        const Node* node = findNode(key, index);
+        return node ? const_cast<Value*>(&node->values[index]) : nullptr;
+    }
+
+    const Value* find(const Key& key) const {
+        int index;
+        const Node* node = findNode(key, index);
+        return node ? &node->values[index] : nullptr;
+    }
+
+    // 取得鍵值對應的值，不存在時擲出 std::out_of_range
+    Value& at(const Key& key) {
+        Value* value = find(key);
+        if (!value) throw std::out_of_range("BTreeMap::at: 鍵值不存在");
+        return *value;
+    }
+
+    const Value& at(const Key& key) const {
+        const Value* value = find(key);
+        if (!value) throw std::out_of_range("BTreeMap::at: 鍵值不存在");
+        return *value;
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != nullptr;
+    }
+
+    // 依鍵值順序對每一組 (key, value) 呼叫 fn
+    template <typename Fn>
+    void forEach(Fn fn) {
+        if (root) forEach(root, fn);
+    }
+
+    // 打印整棵樹的鍵值 (Key 需支援 operator<<)
+    void printTree() const {
+        if (root) printTree(root, 0);
+    }
+};
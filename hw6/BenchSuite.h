@@ -0,0 +1,411 @@
+﻿#pragma once
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_set>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include "MWayTree.h"
+#include "BTree.h"
+#include "BufferedBTree.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// 微基準測試：在不同階數與工作負載下比較 MWayTree、BTree、BufferedBTree 與 std::set，輸出 CSV 或 JSON
+namespace benchsuite {
+
+    enum class OpType : uint8_t { Insert, Remove, Find };
+
+    struct Op {
+        OpType type;
+        int key;
+    };
+
+    // 一個工作負載：先插入 preload (不計時)，再執行 ops (計時)
+    struct Workload {
+        std::string name;
+        std::vector<int> preload;
+        std::vector<Op> ops;
+    };
+
+    struct Result {
+        std::string tree;
+        int order = 0; // MWayTree 的 m、BTree 的 t 或 BufferedBTree 的節點大小，std::set 為 0
+        std::string workload;
+        size_t ops = 0;
+        double seconds = 0;
+        long long peakRssKb = 0;
+        long long rssGrowthKb = 0; // 執行期間尖峰記憶體比開始時多出的量，約為樹本身的大小
+        int height = -1; // std::set 無法取得樹高時為 -1
+        size_t hits = 0; // find 命中次數，用來確認各實作結果一致
+    };
+
+    // 依 Gray 等人的方法產生 [0, n) 內的 Zipf 分布整數，theta 越大越集中在小的值
+    class ZipfianGenerator {
+        uint64_t n;
+        double theta, alpha, zetan, eta;
+
+        static double zeta(uint64_t n, double theta) {
+            double sum = 0;
+            for (uint64_t i = 1; i <= n; i++) sum += 1.0 / std::pow(static_cast<double>(i), theta);
+            return sum;
+        }
+
+    public:
+        ZipfianGenerator(uint64_t n, double theta = 0.99) : n(n), theta(theta) {
+            alpha = 1.0 / (1.0 - theta);
+            zetan = zeta(n, theta);
+            eta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta(2, theta) / zetan);
+        }
+
+        template <typename Rng>
+        uint64_t operator()(Rng& rng) {
+            double u = std::uniform_real_distribution<double>(0, 1)(rng);
+            double uz = u * zetan;
+            if (uz < 1.0) return 0;
+            if (uz < 1.0 + std::pow(0.5, theta)) return 1;
+            return std::min<uint64_t>(n - 1, static_cast<uint64_t>(n * std::pow(eta * u - eta + 1, alpha)));
+        }
+    };
+
+    // 依參考集合決定每個操作，讓 insert 只插入不存在的鍵值、remove 只刪除存在的鍵值，
+    // 如此三種實作面對的是完全相同的工作 (BTree 允許重複鍵值、std::set 不允許)
+    template <typename KeyFn>
+    void appendMixed(Workload& w, size_t count, int insertPct, int removePct, KeyFn nextKey, std::mt19937& rng) {
+        std::unordered_set<int> present(w.preload.begin(), w.preload.end());
+        std::vector<int> live(w.preload.begin(), w.preload.end()); // 可以均勻挑選刪除目標
+        std::unordered_map<int, size_t> slot;
+        for (size_t i = 0; i < live.size(); i++) slot[live[i]] = i;
+
+        w.ops.reserve(w.ops.size() + count);
+        while (w.ops.size() < count) {
+            int roll = static_cast<int>(rng() % 100);
+            int key = nextKey();
+            if (roll < insertPct) {
+                if (present.count(key)) { w.ops.push_back({ OpType::Find, key }); continue; }
+                present.insert(key);
+                slot[key] = live.size();
+                live.push_back(key);
+                w.ops.push_back({ OpType::Insert, key });
+            }
+            else if (roll < insertPct + removePct) {
+                if (live.empty()) continue;
+                if (!present.count(key)) key = live[rng() % live.size()]; // 不存在時改刪一個存在的鍵值
+                size_t index = slot[key];
+                slot[live.back()] = index;
+                std::swap(live[index], live.back());
+                live.pop_back();
+                slot.erase(key);
+                present.erase(key);
+                w.ops.push_back({ OpType::Remove, key });
+            }
+            else {
+                w.ops.push_back({ OpType::Find, key });
+            }
+        }
+    }
+
+    // 建立五種工作負載：sequential、random、zipfian、delete-heavy、write-heavy
+    inline Workload makeWorkload(const std::string& name, int n, uint32_t seed) {
+        std::mt19937 rng(seed);
+        Workload w;
+        w.name = name;
+        if (name == "sequential") { // 遞增插入 n 個鍵值後依序查詢
+            for (int i = 0; i < n; i++) w.ops.push_back({ OpType::Insert, i });
+            for (int i = 0; i < n; i++) w.ops.push_back({ OpType::Find, i });
+        }
+        else if (name == "random") { // 隨機順序插入後隨機查詢
+            std::vector<int> keys(n);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::shuffle(keys.begin(), keys.end(), rng);
+            for (int key : keys) w.ops.push_back({ OpType::Insert, key });
+            for (int i = 0; i < n; i++) w.ops.push_back({ OpType::Find, static_cast<int>(rng() % (2u * n)) });
+        }
+        else if (name == "zipfian") { // 預載一半鍵值，熱門鍵值集中的 50% 查詢 / 40% 插入 / 10% 刪除
+            for (int i = 0; i < n; i += 2) w.preload.push_back(i);
+            std::shuffle(w.preload.begin(), w.preload.end(), rng);
+            ZipfianGenerator zipf(static_cast<uint64_t>(n));
+            // 以乘法雜湊打散熱門鍵值的位置，避免全部集中在樹的最左邊
+            auto nextKey = [&] { return static_cast<int>((zipf(rng) * 2654435761ull) % static_cast<uint64_t>(n)); };
+            appendMixed(w, static_cast<size_t>(n), 40, 10, nextKey, rng);
+        }
+        else if (name == "delete-heavy") { // 預載 n 個鍵值，70% 刪除 / 20% 插入 / 10% 查詢
+            w.preload.resize(n);
+            std::iota(w.preload.begin(), w.preload.end(), 0);
+            std::shuffle(w.preload.begin(), w.preload.end(), rng);
+            auto nextKey = [&] { return static_cast<int>(rng() % static_cast<uint32_t>(n)); };
+            appendMixed(w, static_cast<size_t>(n), 20, 70, nextKey, rng);
+        }
+        else if (name == "write-heavy") { // 預載一半鍵值，40% 插入 / 40% 刪除 / 20% 查詢，鍵值均勻分布
+            for (int i = 0; i < n; i += 2) w.preload.push_back(i);
+            std::shuffle(w.preload.begin(), w.preload.end(), rng);
+            auto nextKey = [&] { return static_cast<int>(rng() % static_cast<uint32_t>(n)); };
+            appendMixed(w, static_cast<size_t>(n), 40, 40, nextKey, rng);
+        }
+        return w;
+    }
+
+    // 統一三種實作的介面
+    struct SetAdapter {
+        std::set<int> set;
+        void insert(int key) { set.insert(key); }
+        void remove(int key) { set.erase(key); }
+        bool contains(int key) const { return set.count(key) != 0; }
+        int height() const { return -1; }
+    };
+
+    template <typename Tree>
+    Result runWorkload(Tree& tree, const Workload& w) {
+        for (int key : w.preload) tree.insert(key);
+        size_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const Op& op : w.ops) {
+            switch (op.type) {
+            case OpType::Insert: tree.insert(op.key); break;
+            case OpType::Remove: tree.remove(op.key); break;
+            case OpType::Find: hits += tree.contains(op.key); break;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        Result r;
+        r.workload = w.name;
+        r.ops = w.ops.size();
+        r.seconds = std::chrono::duration<double>(end - start).count();
+        r.height = tree.height();
+        r.hits = hits;
+        return r;
+    }
+
+#ifdef __linux__
+    // 讀取 /proc/self/status 中的欄位 (KiB)，讀不到時回傳 -1
+    inline long long procStatusKb(const std::string& field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, field.size(), field) == 0 && line[field.size()] == ':') return std::stoll(line.substr(field.size() + 1));
+        }
+        return -1;
+    }
+#endif
+
+    // 將尖峰記憶體重設為目前的常駐記憶體 (只有 Linux 支援)
+    inline void resetPeakRss() {
+#ifdef __linux__
+        std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+    }
+
+    // 目前行程的尖峰常駐記憶體 (KiB)
+    inline long long peakRssKb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+#else
+#ifdef __linux__
+        long long hwm = procStatusKb("VmHWM");
+        if (hwm >= 0) return hwm;
+#endif
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // macOS 以位元組為單位
+#else
+        return usage.ru_maxrss;
+#endif
+#endif
+    }
+
+    inline Result runCase(const std::string& tree, int order, const Workload& w) {
+        resetPeakRss();
+        long long startKb = peakRssKb();
+        Result r;
+        if (tree == "mway") {
+            MWayTree t(order);
+            r = runWorkload(t, w);
+        }
+        else if (tree == "btree") {
+            BTree t(order);
+            r = runWorkload(t, w);
+        }
+        else if (tree == "buffered") {
+            BufferedBTree t(order);
+            r = runWorkload(t, w);
+        }
+        else if (tree == "set") {
+            SetAdapter t;
+            r = runWorkload(t, w);
+        }
+        r.tree = tree; // 名稱已由 runSuite 檢查過
+        r.order = order;
+        r.peakRssKb = peakRssKb();
+        r.rssGrowthKb = r.peakRssKb - startKb;
+        return r;
+    }
+
+    // 在子行程中執行，讓每個組合的尖峰記憶體互不影響；Windows 上直接在本行程執行
+    inline Result runIsolated(const std::string& tree, int order, const Workload& w) {
+#ifdef _WIN32
+        return runCase(tree, order, w);
+#else
+        struct Packed {
+            double seconds;
+            long long peakRssKb, rssGrowthKb;
+            int height;
+            size_t ops, hits;
+        };
+        int fds[2];
+        if (pipe(fds) != 0) return runCase(tree, order, w);
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            Result r = runCase(tree, order, w);
+            Packed packed = { r.seconds, r.peakRssKb, r.rssGrowthKb, r.height, r.ops, r.hits };
+            ssize_t written = write(fds[1], &packed, sizeof(packed));
+            _exit(written == sizeof(packed) ? 0 : 1);
+        }
+        close(fds[1]);
+        Packed packed = {};
+        ssize_t got = pid > 0 ? read(fds[0], &packed, sizeof(packed)) : -1;
+        close(fds[0]);
+        if (pid > 0) waitpid(pid, nullptr, 0);
+        if (got != static_cast<ssize_t>(sizeof(packed))) return runCase(tree, order, w); // fork 失敗時退回本行程
+
+        Result r;
+        r.tree = tree;
+        r.order = order;
+        r.workload = w.name;
+        r.seconds = packed.seconds;
+        r.peakRssKb = packed.peakRssKb;
+        r.rssGrowthKb = packed.rssGrowthKb;
+        r.height = packed.height;
+        r.ops = packed.ops;
+        r.hits = packed.hits;
+        return r;
+#endif
+    }
+
+    inline void writeCsv(std::ostream& out, const std::vector<Result>& results) {
+        out << "tree,order,workload,ops,seconds,ops_per_sec,ns_per_op,peak_rss_kb,rss_growth_kb,height,hits\n";
+        for (const Result& r : results) {
+            out << r.tree << "," << r.order << "," << r.workload << "," << r.ops << ","
+                << std::setprecision(6) << r.seconds << "," << std::fixed << std::setprecision(0) << r.ops / r.seconds << ","
+                << std::setprecision(1) << r.seconds * 1e9 / r.ops << std::defaultfloat << "," << r.peakRssKb << "," << r.rssGrowthKb << ",";
+            if (r.height >= 0) out << r.height;
+            out << "," << r.hits << "\n";
+        }
+    }
+
+    inline void writeJson(std::ostream& out, const std::vector<Result>& results) {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            out << "  {\"tree\": \"" << r.tree << "\", \"order\": " << r.order << ", \"workload\": \"" << r.workload
+                << "\", \"ops\": " << r.ops << ", \"seconds\": " << std::setprecision(6) << r.seconds
+                << ", \"ops_per_sec\": " << std::fixed << std::setprecision(0) << r.ops / r.seconds
+                << ", \"ns_per_op\": " << std::setprecision(1) << r.seconds * 1e9 / r.ops << std::defaultfloat
+                << ", \"peak_rss_kb\": " << r.peakRssKb << ", \"rss_growth_kb\": " << r.rssGrowthKb << ", \"height\": ";
+            if (r.height >= 0) out << r.height;
+            else out << "null";
+            out << ", \"hits\": " << r.hits << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    }
+
+    inline std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> items;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+
+    // hw6_bench [--n N] [--orders 2,4,...] [--trees mway,btree,buffered,set] [--workloads sequential,random,zipfian,delete-heavy,write-heavy]
+    //           [--format csv|json]
+    inline int runSuite(int argc, char* argv[]) {
+        int n = 200000;
+        std::vector<std::string> orders = { "2", "4", "8", "16", "32", "64", "128", "256" };
+        std::vector<std::string> trees = { "mway", "btree", "buffered", "set" };
+        std::vector<std::string> workloads = { "sequential", "random", "zipfian", "delete-heavy", "write-heavy" };
+        std::string format = "csv";
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "參數缺少值: " << arg << "\n";
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--n") n = std::stoi(value);
+            else if (arg == "--orders") orders = splitList(value);
+            else if (arg == "--trees") trees = splitList(value);
+            else if (arg == "--workloads") workloads = splitList(value);
+            else if (arg == "--format") format = value;
+            else {
+                std::cerr << "未知的參數: " << arg << "\n";
+                return 1;
+            }
+        }
+
+        for (const std::string& tree : trees) {
+            if (tree != "mway" && tree != "btree" && tree != "buffered" && tree != "set") {
+                std::cerr << "未知的樹: " << tree << " (可用 mway、btree、buffered、set)\n";
+                return 1;
+            }
+        }
+        if (format != "csv" && format != "json") {
+            std::cerr << "--format 只能是 csv 或 json\n";
+            return 1;
+        }
+
+        std::vector<Result> results;
+        for (const std::string& name : workloads) {
+            Workload w = makeWorkload(name, n, 11);
+            if (w.ops.empty()) {
+                std::cerr << "未知的工作負載: " << name << "\n";
+                return 1;
+            }
+            for (const std::string& tree : trees) {
+                if (tree == "set") { // std::set 與階數無關，只跑一次
+                    results.push_back(runIsolated(tree, 0, w));
+                    std::cerr << tree << " " << name << " 完成\n";
+                    continue;
+                }
+                for (const std::string& orderText : orders) {
+                    int order = std::stoi(orderText);
+                    if (tree == "mway" && order < 3) continue; // m-way 樹至少需要 3 階
+                    if (tree == "btree" && order < 2) continue;
+                    if (tree == "buffered" && order < 4) continue; // 節點大小至少為 4
+                    results.push_back(runIsolated(tree, order, w));
+                    std::cerr << tree << " " << order << " " << name << " 完成\n";
+                }
+            }
+        }
+
+        if (format == "json") writeJson(std::cout, results);
+        else writeCsv(std::cout, results);
+        return 0;
+    }
+}
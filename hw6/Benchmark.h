@@ -0,0 +1,772 @@
+﻿#pragma once
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <set>
+#include <map>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <filesystem>
+#include <cstdio>
+#include <sstream>
+#include "MWayTree.h"
+#include "BTree.h"
+#include "StaticBTree.h"
+#include "BPlusTree.h"
+#include "ConcurrentBTree.h"
+#include "PagedBTree.h"
+#include "BTreeMap.h"
+#include "BufferedBTree.h"
+#include "StringBTree.h"
+
+// 量測 fn 執行所需的毫秒數
+template <typename Fn>
+double measureMillis(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// 比較逐一 insert 與 bulkLoad 建立 n 個鍵值的時間
+inline void runBulkLoadBenchmark(int n, int m, int t) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<int> shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+    std::cout << "批次建樹效能比較 (n = " << n << ", m = " << m << ", t = " << t << ")\n";
+    std::cout << std::left << std::setw(28) << "方法" << std::right << std::setw(12) << "毫秒" << "\n";
+    auto report = [](const char* name, double ms) {
+        std::cout << std::left << std::setw(28) << name << std::right << std::setw(12) << std::fixed << std::setprecision(2) << ms << "\n";
+    };
+
+    report("MWayTree insert (亂序)", measureMillis([&] { MWayTree tree(m); for (int k : shuffled) tree.insert(k); }));
+    report("MWayTree bulkLoad (亂序)", measureMillis([&] { MWayTree tree(m); tree.bulkLoad(shuffled.begin(), shuffled.end()); }));
+    report("MWayTree bulkLoad (已排序)", measureMillis([&] { MWayTree tree(m); tree.bulkLoad(keys.begin(), keys.end()); }));
+    report("BTree insert (亂序)", measureMillis([&] { BTree tree(t); for (int k : shuffled) tree.insert(k); }));
+    report("BTree bulkLoad (亂序)", measureMillis([&] { BTree tree(t); tree.bulkLoad(shuffled.begin(), shuffled.end()); }));
+    report("BTree bulkLoad (已排序)", measureMillis([&] { BTree tree(t); tree.bulkLoad(keys.begin(), keys.end()); }));
+}
+
+// 量測 find 的查詢時間 (一半命中、一半未命中)
+inline void runLookupBenchmark(int n, int m, int t) {
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; i++) keys[i] = 2 * i; // 偶數存在，奇數不存在
+    std::vector<int> probes(n);
+    std::mt19937 rng(7);
+    for (int& p : probes) p = static_cast<int>(rng() % (2u * n));
+
+    MWayTree mwayTree(m);
+    mwayTree.bulkLoad(keys.begin(), keys.end());
+    BTree bTree(t);
+    bTree.bulkLoad(keys.begin(), keys.end());
+
+    std::cout << "查詢效能比較 (n = " << n << ", m = " << m << ", t = " << t << ")\n";
+    long long hits = 0;
+    double mwayMs = measureMillis([&] { for (int p : probes) hits += mwayTree.contains(p); });
+    double bTreeMs = measureMillis([&] { for (int p : probes) hits += bTree.contains(p); });
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "MWayTree contains: " << mwayMs * 1e6 / n << " ns/op\n";
+    std::cout << "BTree contains:    " << bTreeMs * 1e6 / n << " ns/op\n";
+    std::cout << "命中次數: " << hits << "\n";
+}
+
+// 比較執行期階數 (std::vector 節點) 與編譯期階數 (內嵌陣列節點) 的插入與查詢時間
+inline void runStaticLayoutBenchmark(int n) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    std::cout << "節點配置比較 (n = " << n << ", m = 64, t = 32)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    auto report = [n](const char* name, double insertMs, double findMs) {
+        std::cout << std::left << std::setw(24) << name << std::right
+                  << " insert " << std::setw(8) << insertMs * 1e6 / n << " ns/op"
+                  << "  contains " << std::setw(8) << findMs * 1e6 / n << " ns/op\n";
+    };
+
+    long long hits = 0;
+    {
+        MWayTree tree(64);
+        double insertMs = measureMillis([&] { for (int k : keys) tree.insert(k); });
+        report("MWayTree(64)", insertMs, measureMillis([&] { for (int k : keys) hits += tree.contains(k); }));
+    }
+    {
+        StaticMWayTree<64> tree;
+        double insertMs = measureMillis([&] { for (int k : keys) tree.insert(k); });
+        report("StaticMWayTree<64>", insertMs, measureMillis([&] { for (int k : keys) hits += tree.contains(k); }));
+    }
+    {
+        BTree tree(32);
+        double insertMs = measureMillis([&] { for (int k : keys) tree.insert(k); });
+        report("BTree(32)", insertMs, measureMillis([&] { for (int k : keys) hits += tree.contains(k); }));
+    }
+    {
+        StaticBTree<32> tree;
+        double insertMs = measureMillis([&] { for (int k : keys) tree.insert(k); });
+        report("StaticBTree<32>", insertMs, measureMillis([&] { for (int k : keys) hits += tree.contains(k); }));
+    }
+    std::cout << "命中次數: " << hits << "\n";
+}
+
+// 比較 B+-tree 與 std::set 的範圍查詢：每次查詢 [lo, lo + width] 並加總結果
+inline void runRangeScanBenchmark(int n, int t, int queries, int width) {
+    BPlusTree tree(t);
+    std::set<int> baseline;
+    for (int i = 0; i < n; i++) {
+        tree.insert(i);
+        baseline.insert(i);
+    }
+    std::vector<int> starts(queries);
+    std::mt19937 rng(11);
+    for (int& lo : starts) lo = static_cast<int>(rng() % n);
+
+    long long treeSum = 0, setSum = 0;
+    double treeMs = measureMillis([&] {
+        for (int lo : starts) for (int key : tree.range(lo, lo + width)) treeSum += key;
+    });
+    double setMs = measureMillis([&] {
+        for (int lo : starts) {
+            for (auto it = baseline.lower_bound(lo), last = baseline.upper_bound(lo + width); it != last; ++it) setSum += *it;
+        }
+    });
+
+    std::cout << "範圍查詢比較 (n = " << n << ", t = " << t << ", 每次 " << width + 1 << " 個鍵值)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "BPlusTree range: " << treeMs * 1e6 / queries << " ns/query\n";
+    std::cout << "std::set:        " << setMs * 1e6 / queries << " ns/query\n";
+    std::cout << "總和檢查: " << (treeSum == setSum ? "一致" : "不一致") << "\n";
+}
+
+// 以 threads 個執行緒同時對 tree 執行 opsPerThread 次操作，readPercent% 為查詢，其餘插入與刪除各半
+// 回傳每秒總操作數
+template <typename Tree>
+double runMixedWorkload(Tree& tree, int threads, int opsPerThread, int readPercent, int keySpace) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int id = 0; id < threads; id++) {
+        workers.emplace_back([&tree, id, opsPerThread, readPercent, keySpace] {
+            std::mt19937 rng(1000 + id);
+            for (int i = 0; i < opsPerThread; i++) {
+                int key = static_cast<int>(rng() % keySpace);
+                int op = static_cast<int>(rng() % 100);
+                if (op < readPercent) tree.contains(key);
+                else if (op % 2 == 0) tree.insert(key);
+                else tree.remove(key);
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(threads) * opsPerThread / seconds;
+}
+
+// 以 std::shared_mutex 保護整棵樹的基準實作
+template <int T>
+class LockedStaticBTree {
+    StaticBTree<T> tree;
+    mutable std::shared_mutex mutex;
+
+public:
+    bool contains(int key) const { std::shared_lock<std::shared_mutex> lock(mutex); return tree.contains(key); }
+    void insert(int key) { std::unique_lock<std::shared_mutex> lock(mutex); tree.insert(key); }
+    void remove(int key) { std::unique_lock<std::shared_mutex> lock(mutex); tree.remove(key); }
+};
+
+// 多執行緒擴充性：唯讀、讀寫各半、寫入為主三種比例，執行緒數 1, 2, 4 ... 直到硬體執行緒數
+inline void runConcurrencyBenchmark(int n, int opsPerThread) {
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    int keySpace = 2 * n;
+    struct Mix { const char* name; int readPercent; };
+    const Mix mixes[] = { { "唯讀", 100 }, { "讀寫各半", 50 }, { "寫入為主", 10 } };
+
+    std::cout << "多執行緒擴充性 (初始 " << n << " 個鍵值, 每執行緒 " << opsPerThread << " 次操作, Mops/s)\n";
+    std::cout << std::left << std::setw(16) << "比例" << std::setw(12) << "執行緒"
+              << std::right << std::setw(16) << "ConcurrentBTree" << std::setw(16) << "shared_mutex" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Mix& mix : mixes) {
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            ConcurrentBTree<32> concurrent;
+            LockedStaticBTree<32> locked;
+            for (int i = 0; i < keySpace; i += 2) {
+                concurrent.insert(i);
+                locked.insert(i);
+            }
+            double olc = runMixedWorkload(concurrent, threads, opsPerThread, mix.readPercent, keySpace);
+            double coarse = runMixedWorkload(locked, threads, opsPerThread, mix.readPercent, keySpace);
+            std::cout << std::left << std::setw(16) << mix.name << std::setw(12) << threads
+                      << std::right << std::setw(16) << olc / 1e6 << std::setw(16) << coarse / 1e6 << "\n";
+        }
+    }
+}
+
+// 比較逐一 insert/remove 與 insertBatch/removeBatch：先建 n 個鍵值，再以每批 batchSize 個鍵值寫入與刪除
+// 每批的鍵值集中在一段連續區間內 (亂序給出)，模擬依時間分批送達的資料
+inline void runBatchBenchmark(int n, int t, int batchSize, int batches) {
+    std::vector<int> initial(n);
+    for (int i = 0; i < n; i++) initial[i] = 2 * i;
+    std::mt19937 rng(21);
+    std::vector<std::vector<int>> work(batches);
+    for (auto& batch : work) {
+        int start = static_cast<int>(rng() % (2u * n)) & ~1;
+        batch.resize(batchSize);
+        for (int j = 0; j < batchSize; j++) batch[j] = start + 2 * j + 1; // 奇數，不與初始鍵值重複
+        std::shuffle(batch.begin(), batch.end(), rng);
+    }
+
+    std::cout << "批次寫入比較 (n = " << n << ", t = " << t << ", 每批 " << batchSize << " 個, 共 " << batches << " 批)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    long long ops = static_cast<long long>(batchSize) * batches;
+    {
+        BTree tree(t);
+        tree.bulkLoad(initial.begin(), initial.end());
+        double insertMs = measureMillis([&] { for (auto& batch : work) for (int key : batch) tree.insert(key); });
+        double removeMs = measureMillis([&] { for (auto& batch : work) for (int key : batch) tree.remove(key); });
+        std::cout << "逐一 insert/remove:      " << insertMs * 1e6 / ops << " / " << removeMs * 1e6 / ops << " ns/key\n";
+    }
+    {
+        BTree tree(t);
+        tree.bulkLoad(initial.begin(), initial.end());
+        double insertMs = measureMillis([&] { for (auto& batch : work) tree.insertBatch(batch); });
+        double removeMs = measureMillis([&] { for (auto& batch : work) tree.removeBatch(batch); });
+        std::cout << "insertBatch/removeBatch: " << insertMs * 1e6 / ops << " / " << removeMs * 1e6 / ops << " ns/key\n";
+    }
+}
+
+// 磁碟頁面 B-tree：資料量逐步超過緩衝池容量時的插入與查詢吞吐量，最後以唯讀 mmap 模式查詢
+inline void runPagedBenchmark(int n, size_t poolPages, int lookups) {
+    std::mt19937 rng(8);
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::string path = (std::filesystem::temp_directory_path() / "hw6_paged.db").string();
+    const int stages = 8;
+
+    for (size_t pageSize : { size_t(4096), size_t(16384) }) {
+        std::remove(path.c_str());
+        std::cout << "磁碟頁面 B-tree (頁面 " << pageSize / 1024 << " KiB, 緩衝池 " << poolPages << " 頁)\n";
+        std::cout << std::fixed << std::setprecision(1);
+        {
+            PagedBTree tree(path, pageSize, poolPages);
+            int inserted = 0;
+            for (int stage = 1; stage <= stages; stage++) {
+                int target = static_cast<int>(static_cast<long long>(n) * stage / stages);
+                double insertMs = measureMillis([&] { for (; inserted < target; inserted++) tree.insert(keys[inserted]); });
+                double insertNs = insertMs * 1e6 / std::max(1, target - static_cast<int>(static_cast<long long>(n) * (stage - 1) / stages));
+                size_t lookupHits = tree.poolHits(), lookupMisses = tree.poolMisses();
+                size_t found = 0;
+                double lookupMs = measureMillis([&] { for (int i = 0; i < lookups; i++) found += tree.contains(keys[rng() % target]); });
+                double hitRate = 100.0 * (tree.poolHits() - lookupHits) / std::max<size_t>(1, tree.poolHits() - lookupHits + tree.poolMisses() - lookupMisses);
+                std::cout << "  " << target << " 鍵 / " << tree.pageCount() << " 頁: insert " << insertNs << " ns/key, contains "
+                          << lookupMs * 1e6 / lookups << " ns/op, 查詢命中率 " << hitRate << "%"
+                          << (found == static_cast<size_t>(lookups) ? "" : " (錯誤)") << "\n";
+            }
+        }
+        {
+            PagedBTree tree(path, pageSize, 0, PagedBTree::Mode::ReadOnlyMmap);
+            size_t found = 0;
+            double lookupMs = measureMillis([&] { for (int i = 0; i < lookups; i++) found += tree.contains(keys[rng() % n]); });
+            std::cout << "  唯讀 mmap: contains " << lookupMs * 1e6 / lookups << " ns/op"
+                      << (found == static_cast<size_t>(lookups) ? "" : " (錯誤)") << "\n";
+        }
+    }
+    std::remove(path.c_str());
+}
+
+// 重新啟動的成本：逐一 insert 重播所有鍵值 vs 由快照載入
+inline void runSnapshotBenchmark(int n, int m, int t) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(9));
+    std::string path = (std::filesystem::temp_directory_path() / "hw6_tree.snap").string();
+
+    std::cout << "快照存取比較 (n = " << n << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    {
+        BTree tree(t);
+        double replayMs = measureMillis([&] { for (int key : keys) tree.insert(key); });
+        double saveMs = measureMillis([&] { tree.saveSnapshot(path); });
+        BTree restored(t);
+        double loadMs = measureMillis([&] { restored.loadSnapshot(path); });
+        std::cout << "BTree    (t = " << t << "): 重播 insert " << replayMs << " ms, saveSnapshot " << saveMs << " ms, loadSnapshot " << loadMs << " ms\n";
+    }
+    {
+        MWayTree tree(m);
+        double replayMs = measureMillis([&] { for (int key : keys) tree.insert(key); });
+        double saveMs = measureMillis([&] { tree.saveSnapshot(path); });
+        MWayTree restored(m);
+        double loadMs = measureMillis([&] { restored.loadSnapshot(path); });
+        std::cout << "MWayTree (m = " << m << "): 重播 insert " << replayMs << " ms, saveSnapshot " << saveMs << " ms, loadSnapshot " << loadMs << " ms\n";
+    }
+    std::remove(path.c_str());
+}
+
+// 鍵值對索引：BTreeMap 與 std::map 存放只能移動的 payload 時的插入、查詢與刪除時間
+inline void runKeyValueBenchmark(int n, int t) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(13));
+    using Payload = std::unique_ptr<std::string>;
+
+    std::cout << "鍵值對索引比較 (n = " << n << ", t = " << t << ", payload = unique_ptr<string>)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    long long sum = 0;
+    {
+        BTreeMap<int, Payload> map(t);
+        double insertMs = measureMillis([&] { for (int key : keys) map.emplace(key, std::make_unique<std::string>(16, 'x')); });
+        double findMs = measureMillis([&] { for (int key : keys) sum += (*map.find(key))->size(); });
+        double eraseMs = measureMillis([&] { for (int key : keys) map.erase(key); });
+        std::cout << "BTreeMap: emplace " << insertMs * 1e6 / n << " ns, find " << findMs * 1e6 / n << " ns, erase " << eraseMs * 1e6 / n << " ns\n";
+    }
+    {
+        std::map<int, Payload> map;
+        double insertMs = measureMillis([&] { for (int key : keys) map.emplace(key, std::make_unique<std::string>(16, 'x')); });
+        double findMs = measureMillis([&] { for (int key : keys) sum += map.find(key)->second->size(); });
+        double eraseMs = measureMillis([&] { for (int key : keys) map.erase(key); });
+        std::cout << "std::map: emplace " << insertMs * 1e6 / n << " ns, find " << findMs * 1e6 / n << " ns, erase " << eraseMs * 1e6 / n << " ns\n";
+    }
+    if (sum != 32LL * n) std::cout << "結果不一致\n";
+}
+
+// order statistics：維護子樹大小的額外插入成本，以及 countRange 與逐一走訪計數的比較
+inline void runOrderStatisticBenchmark(int n, int t, int queries) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(14));
+    std::mt19937 rng(15);
+    std::vector<std::pair<int, int>> ranges(queries);
+    for (auto& range : ranges) {
+        range.first = static_cast<int>(rng() % n);
+        range.second = range.first + static_cast<int>(rng() % (n / 10 + 1));
+    }
+
+    std::cout << "order statistics 比較 (n = " << n << ", t = " << t << ", " << queries << " 次範圍計數)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    BTree plain(t), augmented(t, true);
+    double plainMs = measureMillis([&] { for (int key : keys) plain.insert(key); });
+    double augmentedMs = measureMillis([&] { for (int key : keys) augmented.insert(key); });
+    std::cout << "insert: 一般 " << plainMs * 1e6 / n << " ns/key, 維護子樹大小 " << augmentedMs * 1e6 / n << " ns/key\n";
+
+    long long scanned = 0, counted = 0;
+    double scanMs = measureMillis([&] { for (auto& range : ranges) plain.forEachInRange(range.first, range.second, [&](int) { scanned++; }); });
+    double countMs = measureMillis([&] { for (auto& range : ranges) counted += augmented.countRange(range.first, range.second); });
+    std::cout << "範圍計數: 逐一走訪 " << scanMs * 1e6 / queries << " ns/query, countRange " << countMs * 1e6 / queries << " ns/query"
+              << (scanned == counted ? "" : " (結果不一致)") << "\n";
+}
+
+// 平行建樹與平行範圍彙總：執行緒數由 1 倍增到硬體執行緒數
+inline void runParallelBuildBenchmark(int n, int t) {
+    std::vector<int> keys(n);
+    std::mt19937 rng(16);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+
+    std::cout << "平行建樹比較 (n = " << n << ", t = " << t << ", 未排序輸入)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    long long expected = 0;
+    {
+        BTree tree(t);
+        double buildMs = measureMillis([&] { tree.bulkLoad(keys.begin(), keys.end()); });
+        double reduceMs = measureMillis([&] { expected = tree.reduceRange(0, INT32_MAX, 0LL, [](int key) { return static_cast<long long>(key); }, std::plus<long long>()); });
+        std::cout << "bulkLoad:            建樹 " << buildMs << " ms, reduceRange " << reduceMs << " ms\n";
+    }
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        ThreadPool workers(threads);
+        BTree tree(t);
+        long long sum = 0;
+        double buildMs = measureMillis([&] { tree.parallelBulkLoad(keys.begin(), keys.end(), workers); });
+        double reduceMs = measureMillis([&] { sum = tree.parallelReduceRange(0, INT32_MAX, 0LL, [](int key) { return static_cast<long long>(key); }, std::plus<long long>(), workers); });
+        std::cout << "parallelBulkLoad x" << std::setw(2) << threads << ": 建樹 " << buildMs << " ms, parallelReduceRange " << reduceMs << " ms"
+                  << (sum == expected ? "" : " (結果不一致)") << "\n";
+        if (threads == maxThreads) break;
+    }
+}
+
+// 快照 (path copying)：取得快照的成本、有快照存在時每次寫入多複製的節點數，以及背景執行緒讀取快照時寫入是否受影響
+inline void runVersioningBenchmark(int n, int t, int writes) {
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; i++) keys[i] = 2 * i; // 偶數鍵值先建好，寫入時插入奇數鍵值
+    std::vector<int> updates(writes);
+    std::mt19937 rng(17);
+    for (int& key : updates) key = 2 * static_cast<int>(rng() % n) + 1;
+
+    std::cout << "快照比較 (n = " << n << ", t = " << t << ", " << writes << " 次寫入)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    const int takes = 100000;
+    BTree tree(t);
+    tree.bulkLoad(keys.begin(), keys.end());
+    double takeMs = measureMillis([&] { for (int i = 0; i < takes; i++) tree.snapshot(); });
+    std::cout << "snapshot(): " << takeMs * 1e6 / takes << " ns (樹高 " << tree.height() << ")\n";
+
+    double plainMs = measureMillis([&] { for (int key : updates) tree.insert(key); });
+    for (int key : updates) tree.remove(key);
+
+    // 每 100 次寫入取一次新快照並丟掉舊的，模擬定期產生報表
+    tree.resetOpStats();
+    BTree::Snapshot report;
+    double versionedMs = measureMillis([&] {
+        for (int i = 0; i < writes; i++) {
+            if (i % 100 == 0) report = tree.snapshot();
+            tree.insert(updates[i]);
+        }
+    });
+    std::cout << "insert: 無快照 " << plainMs * 1e6 / writes << " ns/op, 每 100 次取快照 " << versionedMs * 1e6 / writes << " ns/op, "
+              << static_cast<double>(tree.opStats().nodesCopied) / writes << " 個複製節點/op\n";
+    for (int key : updates) tree.remove(key);
+
+    // 背景執行緒反覆加總同一份快照，主執行緒同時寫入；快照內容必須維持不變
+    BTree::Snapshot frozen = tree.snapshot();
+    long long expected = frozen.reduceRange(0, INT32_MAX, 0LL, [](int key) { return static_cast<long long>(key); }, std::plus<long long>());
+    std::atomic<bool> done{ false };
+    std::atomic<long long> scans{ 0 }, mismatches{ 0 };
+    std::thread reader([&] {
+        while (!done.load()) {
+            long long sum = frozen.reduceRange(0, INT32_MAX, 0LL, [](int key) { return static_cast<long long>(key); }, std::plus<long long>());
+            if (sum != expected) mismatches++;
+            scans++;
+        }
+    });
+    double concurrentMs = measureMillis([&] { for (int key : updates) tree.insert(key); });
+    done = true;
+    reader.join();
+    std::cout << "insert (背景讀取快照): " << concurrentMs * 1e6 / writes << " ns/op, 期間完成 " << scans.load() << " 次全表加總"
+              << (mismatches.load() == 0 ? "" : " (快照內容改變)") << "\n";
+}
+
+// 寫入最佳化的 BufferedBTree 與 BTree：分別量測隨機插入、刪除與查詢，查詢另外量測 flush() 之後的成本
+inline void runBufferedBenchmark(int n, int t, int nodeSize) {
+    std::vector<int> keys(n);
+    std::mt19937 rng(18);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+    std::vector<int> victims(keys.begin(), keys.begin() + n / 2);
+    std::shuffle(victims.begin(), victims.end(), rng);
+
+    std::cout << "寫入最佳化比較 (n = " << n << ", BTree t = " << t << ", BufferedBTree 節點大小 " << nodeSize << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    auto report = [&](const char* name, auto& tree, auto afterWrites) {
+        double insertMs = measureMillis([&] { for (int key : keys) tree.insert(key); });
+        double removeMs = measureMillis([&] { for (int key : victims) tree.remove(key); });
+        size_t hits = 0;
+        double findMs = measureMillis([&] { for (int key : keys) hits += tree.contains(key); });
+        std::cout << name << ": insert " << insertMs * 1e6 / n << " ns/op, remove " << removeMs * 1e6 / victims.size()
+                  << " ns/op, find " << findMs * 1e6 / n << " ns/op";
+        afterWrites(hits);
+        std::cout << "\n";
+    };
+    BTree tree(t);
+    size_t expected = 0;
+    report("BTree        ", tree, [&](size_t hits) { expected = hits; });
+    BufferedBTree buffered(nodeSize);
+    report("BufferedBTree", buffered, [&](size_t hits) {
+        size_t pending = buffered.pendingMessages();
+        double flushMs = measureMillis([&] { buffered.flush(); });
+        size_t after = 0;
+        double findMs = measureMillis([&] { for (int key : keys) after += buffered.contains(key); });
+        std::cout << " (緩衝中 " << pending << " 則訊息；flush " << flushMs << " ms 後 find " << findMs * 1e6 / n << " ns/op)"
+                  << (hits == expected && after == expected ? "" : " (結果不一致)");
+    });
+}
+
+// 凍結索引比較：同一批鍵值分別以 BTree、排序陣列的二分搜尋與 Eytzinger 排列的 FrozenIndex 查詢，
+// 並量測整批查詢 (交錯搜尋 + 預取) 與寫入 / 讀回磁碟的時間
+inline void runFrozenBenchmark(int n, int t) {
+    std::vector<int> keys(n);
+    std::mt19937 rng(19);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+    std::vector<int> queries(keys);
+    std::shuffle(queries.begin(), queries.end(), rng);
+    for (size_t i = 0; i < queries.size(); i += 2) queries[i] = static_cast<int>(rng() & 0x7fffffff);
+
+    BTree tree(t);
+    tree.bulkLoad(keys.begin(), keys.end());
+    FrozenIndex frozen;
+    double freezeMs = measureMillis([&] { frozen = tree.freeze(); });
+    std::vector<int> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+
+    std::cout << "凍結索引比較 (n = " << n << ", t = " << t << ", freeze " << std::fixed << std::setprecision(1) << freezeMs
+              << " ms, " << frozen.bytes() / 1024 << " KiB)\n";
+    size_t expected = 0, hits = 0;
+    double treeMs = measureMillis([&] { for (int key : queries) expected += tree.find(key) != nullptr; });
+    double binaryMs = measureMillis([&] { for (int key : queries) hits += std::binary_search(sorted.begin(), sorted.end(), key); });
+    bool same = hits == expected;
+    hits = 0;
+    double frozenMs = measureMillis([&] { for (int key : queries) hits += frozen.contains(key); });
+    same = same && hits == expected;
+    std::vector<const int*> results(queries.size());
+    double batchMs = measureMillis([&] { hits = frozen.findBatch(queries, results); });
+    same = same && hits == expected;
+    auto perOp = [&](double ms) { return ms * 1e6 / queries.size(); };
+    std::cout << "BTree::find " << perOp(treeMs) << " ns/op, std::binary_search " << perOp(binaryMs)
+              << " ns/op, FrozenIndex::find " << perOp(frozenMs) << " ns/op, findBatch " << perOp(batchMs) << " ns/op"
+              << (same ? "" : " (結果不一致)") << "\n";
+
+    const char* path = "hw6_frozen.idx";
+    double saveMs = measureMillis([&] { frozen.save(path); });
+    FrozenIndex loaded;
+    bool ok = false;
+    double loadMs = measureMillis([&] { ok = loaded.load(path); });
+    std::remove(path);
+    std::cout << "save " << saveMs << " ms, load " << loadMs << " ms" << (ok && loaded.size() == frozen.size() ? "" : " (讀回失敗)") << "\n";
+}
+
+// 遞增插入比較：遞增的時間戳記 (可能重複) 走最右葉節點的快速路徑，遞減插入則每次都由根往下並對半分裂，
+// 比較每次插入的時間、葉層填充率與節點佔用的記憶體
+inline void runAppendBenchmark(int n, int t) {
+    std::vector<int> stamps(n);
+    std::mt19937 rng(20);
+    int now = 0;
+    for (int& stamp : stamps) stamp = now += static_cast<int>(rng() % 3);
+
+    std::cout << "遞增插入比較 (n = " << n << ", t = " << t << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    auto report = [&](const char* name, auto first, auto last) {
+        BTree tree(t);
+        double ms = measureMillis([&] { for (auto it = first; it != last; ++it) tree.insert(*it); });
+        ShapeStats shape = tree.shapeStats();
+        std::cout << name << ": " << ms * 1e6 / n << " ns/op, 葉層填充率 " << shape.levels.back().fillFactor() * 100 << "%, "
+                  << shape.bytes / 1024 << " KiB\n";
+    };
+    report("遞增插入", stamps.begin(), stamps.end());
+    report("遞減插入", stamps.rbegin(), stamps.rend());
+}
+
+// 大型樹輸出比較：逐一以 operator<< 寫出每個鍵值 (原本 printTree 的寫法，不含縮排) 與經過輸出緩衝區的縮排輸出、
+// 逐層輸出、DOT 與 JSON 匯出；輸出寫入記憶體，不計終端機的顯示時間
+inline void runRenderBenchmark(int n, int t) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    BTree tree(t);
+    tree.bulkLoad(keys.begin(), keys.end(), 0.7);
+
+    std::cout << "樹輸出比較 (n = " << n << ", t = " << t << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    auto report = [&](const char* name, auto render) {
+        std::ostringstream out;
+        double ms = measureMillis([&] { render(out); });
+        std::cout << name << ": " << ms << " ms, " << out.str().size() / 1024 << " KiB\n";
+    };
+    report("逐鍵 operator<<", [&](std::ostream& out) { tree.forEachInRange(INT32_MIN, INT32_MAX, [&](int key) { out << key << " "; }); });
+    std::streambuf* console = std::cout.rdbuf();
+    report("printTree", [&](std::ostream& out) {
+        std::cout.rdbuf(out.rdbuf());
+        tree.printTree();
+        std::cout.rdbuf(console);
+    });
+    report("printLevels", [&](std::ostream& out) { tree.printLevels(out); });
+    report("printLevels (3 層、每層 8 個節點)", [&](std::ostream& out) { tree.printLevels(out, { 3, 8, 16 }); });
+    report("exportDot", [&](std::ostream& out) { tree.exportDot(out); });
+    report("exportJson", [&](std::ostream& out) { tree.exportJson(out); });
+}
+
+// 線上壓縮比較：插入 n 個鍵值後刪除其中 80%，再以每次 budget 個節點分段執行 compact 直到一輪結束，
+// 比較壓縮前後的填充率、記憶體與查詢時間，並記錄單次 compact 的最長耗時 (兩個請求之間的停頓)
+inline void runCompactionBenchmark(int n, int m, int t, size_t budget) {
+    std::vector<int> keys(n);
+    std::mt19937 rng(21);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x7fffffff);
+    std::vector<int> victims(keys.begin(), keys.begin() + n / 5 * 4);
+
+    std::cout << "線上壓縮比較 (n = " << n << ", 刪除 " << victims.size() << " 個, m = " << m << ", t = " << t << ", budget = " << budget << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    auto report = [&](const char* name, auto& tree) {
+        for (int key : keys) tree.insert(key);
+        for (int key : victims) tree.remove(key);
+        MemoryUsage before = tree.memoryUsage();
+        size_t hits = 0;
+        double findBefore = measureMillis([&] { for (int key : keys) hits += tree.contains(key); });
+
+        size_t slices = 0, freed = 0;
+        double longest = 0;
+        double total = measureMillis([&] {
+            do {
+                double ms = measureMillis([&] { freed += tree.compact(budget, 0.9); });
+                longest = std::max(longest, ms);
+                slices++;
+            } while (tree.compactionPending());
+        });
+        MemoryUsage after = tree.memoryUsage();
+        size_t hitsAfter = 0;
+        double findAfter = measureMillis([&] { for (int key : keys) hitsAfter += tree.contains(key); });
+
+        std::cout << name << ": 填充率 " << before.fillFactor() * 100 << "% -> " << after.fillFactor() * 100 << "%, 節點 "
+                  << before.liveNodes << " -> " << after.liveNodes << " (釋放 " << freed << " 個), 記憶體 "
+                  << before.totalBytes() / 1024 << " KiB -> " << after.totalBytes() / 1024 << " KiB\n"
+                  << "    compact 共 " << total << " ms / " << slices << " 次, 單次最長 " << longest * 1e3 << " us; find "
+                  << findBefore * 1e6 / n << " -> " << findAfter * 1e6 / n << " ns/op" << (hits == hitsAfter ? "" : " (結果不一致)") << "\n";
+    };
+    MWayTree mway(m);
+    report("MWayTree", mway);
+    BTree btree(t);
+    report("BTree   ", btree);
+}
+
+// 刪除不存在鍵值的比較：n 個偶數鍵值建樹後執行 n/2 次刪除，其中三分之一為不存在的奇數，
+// 比較有無 membership filter 的刪除時間、走訪節點數與結構調整次數 (不存在的鍵值不會觸發合併或借用)
+inline void runMissingDeleteBenchmark(int n, int t) {
+    std::vector<int> keys(n);
+    std::mt19937 rng(22);
+    for (int& key : keys) key = static_cast<int>(rng() & 0x3fffffff) * 2;
+    std::vector<int> deletes(n / 2);
+    for (size_t i = 0; i < deletes.size(); i++) {
+        deletes[i] = i % 3 == 0 ? static_cast<int>(rng() & 0x3fffffff) * 2 + 1 : keys[rng() % keys.size()];
+    }
+
+    std::cout << "刪除不存在鍵值比較 (n = " << n << ", 刪除 " << deletes.size() << " 次, 三分之一不存在, t = " << t << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    auto report = [&](const char* name, bool useFilter) {
+        BTree tree(t);
+        tree.bulkLoad(keys.begin(), keys.end(), 0.7);
+        tree.setReportMissing(false);
+        if (useFilter) tree.enableMembershipFilter();
+        tree.resetOpStats();
+        double ms = measureMillis([&] { for (int key : deletes) tree.remove(key); });
+        const OpStats& s = tree.opStats();
+        std::cout << name << ": " << ms * 1e6 / deletes.size() << " ns/op, " << s.nodesPerOperation() << " 個節點/op, 合併與借用 "
+                  << s.merge + s.borrowFromPrev + s.borrowFromNext << " 次, filter 排除 " << s.filterRejects << " 次, filter "
+                  << tree.membershipFilterBytes() / 1024 << " KiB\n";
+    };
+    report("無 filter", false);
+    report("Bloom filter", true);
+}
+
+// 以 std::string 直接當鍵值的 B+-tree 基準實作：每個節點最多 2t-1 個完整字串，分隔鍵為右半第一個完整的鍵值
+class NaiveStringBPlusTree {
+    struct Node {
+        bool leaf;
+        std::vector<std::string> keys;
+        std::vector<Node*> children;
+    };
+
+    std::deque<Node> nodes; // 節點只增不減，基準測試只需要插入與查詢
+    Node* root = nullptr;
+    int t;
+
+    Node* create(bool leaf) {
+        Node& node = nodes.emplace_back();
+        node.leaf = leaf;
+        node.keys.reserve(2 * t - 1);
+        if (!leaf) node.children.reserve(2 * t);
+        return &node;
+    }
+
+    static int childIndex(const Node* node, std::string_view key) {
+        return static_cast<int>(std::upper_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin());
+    }
+
+    void splitChild(Node* parent, int i) {
+        Node* y = parent->children[i];
+        Node* z = create(y->leaf);
+        std::string separator;
+        if (y->leaf) {
+            z->keys.assign(std::make_move_iterator(y->keys.begin() + t), std::make_move_iterator(y->keys.end()));
+            y->keys.resize(t);
+            separator = z->keys[0];
+        }
+        else {
+            separator = std::move(y->keys[t - 1]);
+            z->keys.assign(std::make_move_iterator(y->keys.begin() + t), std::make_move_iterator(y->keys.end()));
+            z->children.assign(y->children.begin() + t, y->children.end());
+            y->keys.resize(t - 1);
+            y->children.resize(t);
+        }
+        parent->keys.insert(parent->keys.begin() + i, std::move(separator));
+        parent->children.insert(parent->children.begin() + i + 1, z);
+    }
+
+public:
+    explicit NaiveStringBPlusTree(int t) : t(t) {}
+
+    bool insert(std::string_view key) {
+        if (!root) {
+            root = create(true);
+        }
+        else if (static_cast<int>(root->keys.size()) == 2 * t - 1) {
+            Node* newRoot = create(false);
+            newRoot->children.push_back(root);
+            root = newRoot;
+            splitChild(root, 0);
+        }
+        Node* node = root;
+        while (!node->leaf) {
+            int i = childIndex(node, key);
+            if (static_cast<int>(node->children[i]->keys.size()) == 2 * t - 1) {
+                splitChild(node, i);
+                if (key >= node->keys[i]) i++;
+            }
+            node = node->children[i];
+        }
+        auto it = std::lower_bound(node->keys.begin(), node->keys.end(), key);
+        if (it != node->keys.end() && *it == key) return false;
+        node->keys.emplace(it, key);
+        return true;
+    }
+
+    bool contains(std::string_view key) const {
+        const Node* node = root;
+        if (!node) return false;
+        while (!node->leaf) node = node->children[childIndex(node, key)];
+        return std::binary_search(node->keys.begin(), node->keys.end(), key);
+    }
+
+    // 與 StringBTree::stats 相同的統計，記憶體包含 std::string 放不進內部緩衝區時另外配置的空間
+    StringTreeStats stats() const {
+        StringTreeStats result;
+        for (const Node* node = root; node; node = node->leaf ? nullptr : node->children[0]) result.height++;
+        for (const Node& node : nodes) {
+            (node.leaf ? result.leafNodes : result.internalNodes)++;
+            result.bytes += sizeof(Node) + node.keys.capacity() * sizeof(std::string) + node.children.capacity() * sizeof(Node*);
+            for (const std::string& key : node.keys) {
+                if (key.capacity() > std::string().capacity()) result.bytes += key.capacity() + 1;
+                if (node.leaf) result.keys++;
+                else result.separatorBytes += key.size();
+            }
+            if (!node.leaf) result.separators += node.keys.size();
+        }
+        return result;
+    }
+};
+
+// 字串鍵值比較：n 個類似 URL 的鍵值 (共同前綴很長)，比較 slotted page + 前綴壓縮 + 最短分隔鍵的 StringBTree
+// 與直接存放 std::string 的 B+-tree 的插入、查詢時間、樹高、分隔鍵長度與記憶體
+inline void runStringKeyBenchmark(int n, int t) {
+    static const char* hosts[] = { "https://www.example.com/catalog/", "https://static.example.com/assets/images/", "https://api.example.com/v2/users/" };
+    std::vector<std::string> keys(n);
+    std::mt19937 rng(23);
+    for (std::string& key : keys) {
+        key = hosts[rng() % 3];
+        key += "category-" + std::to_string(rng() % 200) + "/item-" + std::to_string(rng() % 10000000) + "?ref=home";
+    }
+    std::vector<std::string> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), rng);
+
+    std::cout << "字串鍵值比較 (n = " << n << ", 平均長度 " << std::accumulate(keys.begin(), keys.end(), size_t{ 0 }, [](size_t sum, const std::string& key) { return sum + key.size(); }) / std::max(n, 1)
+              << " bytes, 頁面 " << strkey::kPageSize << " bytes, 基準 t = " << t << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    auto report = [&](const char* name, auto& tree) {
+        double insertMs = measureMillis([&] { for (const std::string& key : keys) tree.insert(key); });
+        size_t hits = 0;
+        double findMs = measureMillis([&] { for (const std::string& key : probes) hits += tree.contains(key); });
+        StringTreeStats s = tree.stats();
+        std::cout << name << ": insert " << insertMs * 1e6 / n << " ns/op, contains " << findMs * 1e6 / n << " ns/op, 樹高 " << s.height
+                  << ", 內部節點 " << s.internalNodes << ", 分隔鍵平均 " << s.averageSeparatorLength() << " bytes, 記憶體 "
+                  << s.bytes / 1024 / 1024 << " MiB" << (hits == probes.size() ? "" : " (結果不一致)") << "\n";
+    };
+    NaiveStringBPlusTree naive(t);
+    report("std::string B+-tree", naive);
+    StringBTree compressed;
+    report("StringBTree        ", compressed);
+}
@@ -0,0 +1,492 @@
+﻿#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include "BulkLoad.h"
+#include "TreeStats.h"
+
+// 寫入最佳化的 B-tree (B^ε-tree)：內部節點除了分隔鍵之外還有一個訊息緩衝區，
+// insert / remove 只把訊息附加到根節點的緩衝區，緩衝區滿時才把訊息最多的子節點那一段一次往下推，
+// 因此寫入不必每次走到葉節點，搬動節點的成本由許多筆寫入分攤；查詢時沿路合併緩衝區中尚未套用的訊息
+namespace buffered {
+
+    // 某個鍵值上尚未套用的訊息：把該鍵值原本的個數 c 變成 max(c + delta, floor)
+    // 插入為 (+1, 0)，刪除一個為 (-1, 0) (不存在時不變)；同一鍵值的多則訊息可依先後合成一則
+    struct Message {
+        int key;
+        int delta;
+        int floor;
+
+        size_t apply(size_t count) const {
+            long long c = static_cast<long long>(count) + delta;
+            return static_cast<size_t>(std::max<long long>(c, floor));
+        }
+
+        // 不改變任何個數的訊息 (例如插入後又刪除)，可以直接丟掉
+        bool identity() const {
+            return delta == 0 && floor == 0;
+        }
+    };
+
+    // 先套用 older 再套用 newer：max(max(c + d1, f1) + d2, f2) = max(c + d1 + d2, max(f1 + d2, f2))
+    inline Message compose(const Message& older, const Message& newer) {
+        return { older.key, older.delta + newer.delta, std::max(older.floor + newer.delta, newer.floor) };
+    }
+}
+
+struct BufferedNode {
+    bool leaf;
+    std::vector<int> keys; // 內部節點為分隔鍵 (第 i 個子節點負責 [keys[i-1], keys[i]))，葉節點為不重複的鍵值
+    std::vector<uint32_t> counts; // 葉節點中每個鍵值的個數 (與 BTree 相同允許重複鍵值)
+    std::vector<BufferedNode*> children;
+    // 內部節點的緩衝區，依子節點分段：pending[i] 為要送往 children[i] 的訊息，依寫入先後排列
+    // 寫入只需附加到一段的尾端，往下推時才排序；查詢只需掃過路徑經過的那一段
+    std::vector<std::vector<buffered::Message>> pending;
+    size_t buffered = 0; // 所有段的訊息總數
+
+    explicit BufferedNode(bool leaf) : leaf(leaf) {}
+};
+
+class BufferedBTree {
+    using Message = buffered::Message;
+    using Batch = std::vector<Message>;
+
+    BufferedNode* root = nullptr;
+    int fanout; // 內部節點最多的子節點數，約為 nodeSize^ε
+    int leafCapacity; // 葉節點最多的鍵值數
+    int bufferCapacity; // 內部節點緩衝區最多的訊息數
+    mutable OpStats stats; // 結構操作計數 (查詢為 const 也需更新)
+    std::vector<int> scratchKeys; // applyToLeaf 重複使用的緩衝區，避免每次配置
+    std::vector<uint32_t> scratchCounts;
+
+    static void destroy(BufferedNode* node) {
+        if (!node) return;
+        for (BufferedNode* child : node->children) destroy(child);
+        delete node;
+    }
+
+    // 鍵值 k 所在的子節點
+    static int childIndex(const BufferedNode* node, int k) {
+        return static_cast<int>(std::upper_bound(node->keys.begin(), node->keys.end(), k) - node->keys.begin());
+    }
+
+    // 節點的大小與上限：葉節點以鍵值數計，內部節點以子節點數計
+    size_t sizeOf(const BufferedNode* node) const {
+        return node->leaf ? node->keys.size() : node->children.size();
+    }
+
+    size_t capacityOf(const BufferedNode* node) const {
+        return node->leaf ? leafCapacity : fanout;
+    }
+
+    // 依鍵值穩定排序 (同一鍵值維持寫入先後)，再把同一鍵值的訊息合成一則，去掉不改變個數的訊息
+    static void coalesce(Batch& batch) {
+        std::stable_sort(batch.begin(), batch.end(), [](const Message& a, const Message& b) { return a.key < b.key; });
+        size_t out = 0;
+        for (size_t i = 0; i < batch.size(); ) {
+            Message msg = batch[i++];
+            while (i < batch.size() && batch[i].key == msg.key) msg = buffered::compose(msg, batch[i++]);
+            if (!msg.identity()) batch[out++] = msg;
+        }
+        batch.resize(out);
+    }
+
+    // 將一批已排序且不重複的訊息套用到葉節點，個數變為 0 的鍵值移除
+    void applyToLeaf(BufferedNode* leaf, const Message* first, const Message* last) {
+        std::vector<int>& keys = scratchKeys;
+        std::vector<uint32_t>& counts = scratchCounts;
+        keys.clear();
+        counts.clear();
+        size_t i = 0;
+        auto emit = [&](int key, size_t count) {
+            if (count == 0) return;
+            keys.push_back(key);
+            counts.push_back(static_cast<uint32_t>(count));
+        };
+        for (; first != last; ++first) {
+            for (; i < leaf->keys.size() && leaf->keys[i] < first->key; i++) emit(leaf->keys[i], leaf->counts[i]);
+            bool present = i < leaf->keys.size() && leaf->keys[i] == first->key;
+            emit(first->key, first->apply(present ? leaf->counts[i] : 0));
+            if (present) i++;
+        }
+        for (; i < leaf->keys.size(); i++) emit(leaf->keys[i], leaf->counts[i]);
+        leaf->keys.swap(keys);
+        leaf->counts.swap(counts);
+    }
+
+    // 將訊息附加到 node 中對應子節點的那一段
+    static void append(BufferedNode* node, const Message& msg) {
+        node->pending[childIndex(node, msg.key)].push_back(msg);
+        node->buffered++;
+    }
+
+    // 將一批訊息推到第 i 個子節點：葉節點排序合成後一次套用，內部節點依分隔鍵附加到各段 (滿了再繼續往下推)
+    void pushDown(BufferedNode* node, int i, Batch& batch) {
+        HW6_COUNT(nodesVisited);
+        BufferedNode* child = node->children[i];
+        if (child->leaf) {
+            coalesce(batch);
+            applyToLeaf(child, batch.data(), batch.data() + batch.size());
+            return;
+        }
+        for (const Message& msg : batch) append(child, msg);
+        if (static_cast<int>(child->buffered) > bufferCapacity) flushBuffer(child);
+    }
+
+    // 緩衝區超出上限時，重複挑出訊息最多的一段，整段一次推到對應的子節點，再修正該子節點的大小
+    void flushBuffer(BufferedNode* node) {
+        Batch batch;
+        while (static_cast<int>(node->buffered) > bufferCapacity) {
+            size_t best = 0;
+            for (size_t i = 1; i < node->pending.size(); i++) {
+                if (node->pending[i].size() > node->pending[best].size()) best = i;
+            }
+            batch.swap(node->pending[best]); // 原本的段接手上一批用過的容量
+            node->pending[best].clear();
+            node->buffered -= batch.size();
+            pushDown(node, static_cast<int>(best), batch);
+            fixChild(node, static_cast<int>(best));
+        }
+    }
+
+    // 子節點超出上限時平均切成數個節點；過小時與相鄰的兄弟合併 (合併後放得下才合併)，葉節點清空時直接移除
+    void fixChild(BufferedNode* node, int i) {
+        BufferedNode* child = node->children[i];
+        size_t size = sizeOf(child), capacity = capacityOf(child);
+        if (size > capacity) {
+            splitChild(node, i);
+            return;
+        }
+        if (node->children.size() < 2 || size >= std::max<size_t>(1, capacity / 4)) return;
+
+        if (size == 0) { // 只有葉節點會清空；送往它的訊息併入接手其鍵值範圍的兄弟 (維持鍵值順序)
+            int heir = i > 0 ? i - 1 : i + 1;
+            Batch& from = node->pending[i];
+            node->pending[heir].insert(node->pending[heir].end(), from.begin(), from.end()); // 鍵值範圍不重疊，同一鍵值的先後不變
+            delete child;
+            node->children.erase(node->children.begin() + i);
+            node->pending.erase(node->pending.begin() + i);
+            node->keys.erase(node->keys.begin() + (i > 0 ? i - 1 : 0));
+            return;
+        }
+        int left = i > 0 ? i - 1 : i;
+        if (sizeOf(node->children[left]) + sizeOf(node->children[left + 1]) <= capacity) mergeChildren(node, left);
+    }
+
+    // 將 from 中鍵值不小於 separator 的訊息移到 to，兩者皆維持原本的先後順序
+    static void splitBatch(Batch& from, Batch& to, int separator) {
+        auto mid = std::stable_partition(from.begin(), from.end(), [separator](const Message& m) { return m.key < separator; });
+        to.assign(mid, from.end());
+        from.erase(mid, from.end());
+    }
+
+    // 將第 i 個子節點平均切成 ceil(size / capacity) 個節點，分隔鍵插入 node
+    void splitChild(BufferedNode* node, int i) {
+        HW6_COUNT(splitChild);
+        BufferedNode* child = node->children[i];
+        int size = static_cast<int>(sizeOf(child));
+        int pieces = (size + static_cast<int>(capacityOf(child)) - 1) / static_cast<int>(capacityOf(child));
+        std::vector<BufferedNode*> created;
+        std::vector<int> separators;
+        std::vector<Batch> parentPending;
+        for (int p = pieces - 1; p > 0; p--) { // 由右往左切下，child 保留最左邊一段
+            int start = size * p / pieces;
+            BufferedNode* piece = new BufferedNode(child->leaf);
+            int separator;
+            if (child->leaf) {
+                separator = child->keys[start];
+                piece->keys.assign(child->keys.begin() + start, child->keys.end());
+                piece->counts.assign(child->counts.begin() + start, child->counts.end());
+                child->keys.resize(start);
+                child->counts.resize(start);
+            }
+            else { // children[start..] 與對應的緩衝段移到新節點，兩者之間的分隔鍵上移
+                separator = child->keys[start - 1];
+                piece->keys.assign(child->keys.begin() + start, child->keys.end());
+                piece->children.assign(child->children.begin() + start, child->children.end());
+                piece->pending.assign(std::make_move_iterator(child->pending.begin() + start), std::make_move_iterator(child->pending.end()));
+                for (const Batch& batch : piece->pending) piece->buffered += batch.size();
+                child->keys.resize(start - 1);
+                child->children.resize(start);
+                child->pending.resize(start);
+                child->buffered -= piece->buffered;
+            }
+            parentPending.emplace_back();
+            splitBatch(node->pending[i], parentPending.back(), separator); // node 中送往 child 的訊息依新的分隔鍵分開
+            created.push_back(piece);
+            separators.push_back(separator);
+        }
+        std::reverse(created.begin(), created.end());
+        std::reverse(separators.begin(), separators.end());
+        std::reverse(parentPending.begin(), parentPending.end());
+        node->children.insert(node->children.begin() + i + 1, created.begin(), created.end());
+        node->keys.insert(node->keys.begin() + i, separators.begin(), separators.end());
+        node->pending.insert(node->pending.begin() + i + 1, std::make_move_iterator(parentPending.begin()), std::make_move_iterator(parentPending.end()));
+    }
+
+    // 合併第 i 與第 i+1 個子節點；兩者的鍵值範圍不重疊，緩衝段直接串接
+    void mergeChildren(BufferedNode* node, int i) {
+        HW6_COUNT(merge);
+        BufferedNode* left = node->children[i];
+        BufferedNode* right = node->children[i + 1];
+        if (!left->leaf) left->keys.push_back(node->keys[i]);
+        left->keys.insert(left->keys.end(), right->keys.begin(), right->keys.end());
+        left->counts.insert(left->counts.end(), right->counts.begin(), right->counts.end());
+        left->children.insert(left->children.end(), right->children.begin(), right->children.end());
+        left->pending.insert(left->pending.end(), std::make_move_iterator(right->pending.begin()), std::make_move_iterator(right->pending.end()));
+        left->buffered += right->buffered;
+        right->children.clear();
+        delete right;
+
+        Batch& from = node->pending[i + 1];
+        node->pending[i].insert(node->pending[i].end(), from.begin(), from.end());
+        node->children.erase(node->children.begin() + i + 1);
+        node->pending.erase(node->pending.begin() + i + 1);
+        node->keys.erase(node->keys.begin() + i);
+        if (!left->leaf && static_cast<int>(left->buffered) > bufferCapacity) {
+            flushBuffer(left);
+            if (sizeOf(left) > capacityOf(left)) splitChild(node, i);
+        }
+    }
+
+    // 根節點超出上限時往上長高；只剩一個子節點時把緩衝區推下去後降低一層
+    void fixRoot() {
+        while (true) {
+            if (sizeOf(root) > capacityOf(root)) {
+                BufferedNode* newRoot = new BufferedNode(false);
+                newRoot->children.push_back(root);
+                newRoot->pending.emplace_back();
+                root = newRoot;
+                splitChild(root, 0);
+            }
+            else if (!root->leaf && root->children.size() == 1) {
+                BufferedNode* old = root;
+                if (!old->pending[0].empty()) pushDown(old, 0, old->pending[0]);
+                root = old->children[0];
+                old->children.clear();
+                delete old;
+            }
+            else {
+                break;
+            }
+        }
+    }
+
+    void write(const Message& msg) {
+        HW6_COUNT(operations);
+        if (!root) root = new BufferedNode(true);
+        if (root->leaf) {
+            applyToLeaf(root, &msg, &msg + 1);
+        }
+        else {
+            append(root, msg);
+            if (static_cast<int>(root->buffered) > bufferCapacity) flushBuffer(root);
+        }
+        fixRoot();
+    }
+
+    // 收集 node 子樹中落在 [lo, hi] 的 (鍵值, 個數)，沿路套用緩衝區中的訊息
+    static void collect(const BufferedNode* node, int lo, int hi, std::vector<std::pair<int, size_t>>& out) {
+        if (node->leaf) {
+            for (size_t i = std::lower_bound(node->keys.begin(), node->keys.end(), lo) - node->keys.begin(); i < node->keys.size() && node->keys[i] <= hi; i++) {
+                out.emplace_back(node->keys[i], node->counts[i]);
+            }
+            return;
+        }
+        for (int i = childIndex(node, lo), last = childIndex(node, hi); i <= last; i++) {
+            size_t start = out.size();
+            collect(node->children[i], lo, hi, out);
+
+            Batch batch;
+            for (const Message& msg : node->pending[i]) {
+                if (msg.key >= lo && msg.key <= hi) batch.push_back(msg);
+            }
+            if (batch.empty()) continue;
+            coalesce(batch);
+            std::vector<std::pair<int, size_t>> below(out.begin() + start, out.end());
+            out.resize(start);
+            auto it = below.begin();
+            for (const Message& msg : batch) {
+                for (; it != below.end() && it->first < msg.key; ++it) out.push_back(*it);
+                bool present = it != below.end() && it->first == msg.key;
+                size_t count = msg.apply(present ? it->second : 0);
+                if (count) out.emplace_back(msg.key, count);
+                if (present) ++it;
+            }
+            out.insert(out.end(), it, below.end());
+        }
+    }
+
+    // 由已排序的 (鍵值, 個數) 由下而上建樹，節點填滿到上限 (flush 時使用)
+    void build(const std::vector<std::pair<int, size_t>>& entries) {
+        destroy(root);
+        root = nullptr;
+        if (entries.empty()) return;
+
+        std::vector<BufferedNode*> level;
+        std::vector<int> lows; // 每個節點子樹中的最小鍵值，作為上一層的分隔鍵
+        size_t pos = 0;
+        for (int size : planNodeSizes(static_cast<int>(entries.size()), std::max(1, leafCapacity / 2), leafCapacity, leafCapacity)) {
+            BufferedNode* leaf = new BufferedNode(true);
+            for (int j = 0; j < size; j++, pos++) {
+                leaf->keys.push_back(entries[pos].first);
+                leaf->counts.push_back(static_cast<uint32_t>(entries[pos].second));
+            }
+            level.push_back(leaf);
+            lows.push_back(leaf->keys.front());
+        }
+        while (level.size() > 1) {
+            std::vector<BufferedNode*> parents;
+            std::vector<int> parentLows;
+            pos = 0;
+            for (int size : planNodeSizes(static_cast<int>(level.size()), std::max(2, fanout / 2), fanout, fanout)) {
+                BufferedNode* node = new BufferedNode(false);
+                for (int j = 0; j < size; j++, pos++) {
+                    if (j > 0) node->keys.push_back(lows[pos]);
+                    node->children.push_back(level[pos]);
+                }
+                node->pending.resize(node->children.size());
+                parentLows.push_back(lows[pos - size]);
+                parents.push_back(node);
+            }
+            level.swap(parents);
+            lows.swap(parentLows);
+        }
+        root = level[0];
+    }
+
+public:
+    // nodeSize 為葉節點與緩衝區的大小 B，內部節點的分支數為 B^epsilon (epsilon = 1 時分支數與一般 B-tree 相同)
+    explicit BufferedBTree(int nodeSize = 256, double epsilon = 0.5)
+        : fanout(std::max(3, static_cast<int>(std::lround(std::pow(std::max(nodeSize, 4), epsilon))))),
+          leafCapacity(std::max(nodeSize, 4)),
+          bufferCapacity(std::max(nodeSize, 4)) {}
+
+    ~BufferedBTree() {
+        destroy(root);
+    }
+
+    BufferedBTree(const BufferedBTree&) = delete;
+    BufferedBTree& operator=(const BufferedBTree&) = delete;
+
+    // 插入鍵值 (允許重複)；只附加到根節點的緩衝區
+    void insert(int k) {
+        write({ k, 1, 0 });
+    }
+
+    // 刪除一個鍵值；鍵值不存在時在訊息套用時自然略過 (寫入當下無法得知，因此不會印出找不到的訊息)
+    void remove(int k) {
+        write({ k, -1, 0 });
+    }
+
+    // 鍵值 k 的個數：由根往下把路徑上的訊息合成一則 (越上層、同一段中越後面的越新)，最後套用到葉節點中的個數
+    size_t count(int k) const {
+        HW6_COUNT(operations);
+        Message newer = { k, 0, 0 };
+        const BufferedNode* node = root;
+        if (!node) return 0;
+        while (!node->leaf) {
+            HW6_COUNT(nodesVisited);
+            int i = childIndex(node, k);
+            const Batch& batch = node->pending[i];
+            for (auto it = batch.rbegin(); it != batch.rend(); ++it) { // 由新到舊
+                if (it->key == k) newer = buffered::compose(*it, newer);
+            }
+            node = node->children[i];
+        }
+        HW6_COUNT(nodesVisited);
+        auto it = std::lower_bound(node->keys.begin(), node->keys.end(), k);
+        bool present = it != node->keys.end() && *it == k;
+        return newer.apply(present ? node->counts[it - node->keys.begin()] : 0);
+    }
+
+    bool contains(int k) const {
+        return count(k) > 0;
+    }
+
+    // 依序對 [lo, hi] 內的每個鍵值呼叫 fn (重複的鍵值呼叫多次)
+    template <typename Fn>
+    void forEachInRange(int lo, int hi, Fn fn) const {
+        if (!root || lo > hi) return;
+        std::vector<std::pair<int, size_t>> entries;
+        collect(root, lo, hi, entries);
+        for (const auto& [key, count] : entries) {
+            for (size_t i = 0; i < count; i++) fn(key);
+        }
+    }
+
+    // 把所有緩衝中的訊息套用到葉節點並重新建樹，之後的查詢不需合併任何訊息 (適合在大量讀取之前呼叫)
+    void flush() {
+        if (!root || root->leaf) return;
+        std::vector<std::pair<int, size_t>> entries;
+        collect(root, INT32_MIN, INT32_MAX, entries);
+        build(entries);
+    }
+
+    // 尚未套用到葉節點的訊息數
+    size_t pendingMessages() const {
+        size_t total = 0;
+        std::vector<const BufferedNode*> stack;
+        if (root) stack.push_back(root);
+        while (!stack.empty()) {
+            const BufferedNode* node = stack.back();
+            stack.pop_back();
+            total += node->buffered;
+            for (const BufferedNode* child : node->children) stack.push_back(child);
+        }
+        return total;
+    }
+
+    void clear() {
+        destroy(root);
+        root = nullptr;
+    }
+
+    int height() const {
+        int levels = 0;
+        for (const BufferedNode* node = root; node; node = node->leaf ? nullptr : node->children[0]) levels++;
+        return levels;
+    }
+
+    const OpStats& opStats() const {
+        return stats;
+    }
+
+    void resetOpStats() {
+        stats = OpStats();
+    }
+
+    // 遞迴地打印：內部節點印出分隔鍵與緩衝區中的訊息 (+1@k 為插入、-1@k 為刪除)，葉節點印出鍵值 (重複者以 k*n 表示)
+    void printTree(const BufferedNode* node, int level) const {
+        if (!node) return;
+        std::cout << std::string(level * 4, ' ');
+        if (node->leaf) {
+            for (size_t i = 0; i < node->keys.size(); i++) {
+                std::cout << node->keys[i];
+                if (node->counts[i] > 1) std::cout << "*" << node->counts[i];
+                std::cout << " ";
+            }
+        }
+        else {
+            for (int key : node->keys) std::cout << key << " ";
+            if (node->buffered) {
+                std::cout << "[";
+                for (const Batch& batch : node->pending) {
+                    for (const Message& msg : batch) std::cout << " " << (msg.delta >= 0 ? "+" : "") << msg.delta << "@" << msg.key;
+                }
+                std::cout << " ]";
+            }
+        }
+        std::cout << "\n";
+        for (const BufferedNode* child : node->children) printTree(child, level + 1);
+    }
+
+    void printTree() const {
+        printTree(root, 0);
+    }
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// 將 items 個子節點 (或葉層的 n+1 個空指標) 均分成若干組，每組成為一個節點
+// minItems / maxItems 為非根節點允許的子節點數範圍，targetItems 為依填充率算出的目標值
+inline std::vector<int> planNodeSizes(int items, int minItems, int maxItems, int targetItems) {
+    if (items <= maxItems) return { items }; // 全部放得進一個節點，即為根節點
+
+    int groups = (items + targetItems - 1) / targetItems; // 依目標填充率估計節點數
+    while (groups > 1 && items / groups < minItems) groups--; // 避免節點低於下限
+    while ((items + groups - 1) / groups > maxItems) groups++; // 避免節點超過上限
+
+    std::vector<int> sizes(groups, items / groups);
+    for (int i = 0; i < items % groups; i++) sizes[i]++; // 餘數平均分給前面的節點
+    return sizes;
+}
+
+// 依填充率計算每個節點的目標鍵值數，並限制在 [minKeys, maxKeys] 內
+inline int targetKeyCount(double fillFactor, int minKeys, int maxKeys) {
+    int target = static_cast<int>(std::lround(fillFactor * maxKeys));
+    return std::max(minKeys, std::min(maxKeys, std::max(target, 1)));
+}
@@ -0,0 +1,370 @@
+﻿#pragma once
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+#include "MWayTree.h"
+#include "BTree.h"
+
+// 非互動的指令驅動模式：從檔案或管線讀入指令串流，對 MWayTree 或 BTree 執行後輸出吞吐量與延遲分位數
+//
+// 文字格式每行一個指令 (# 之後為註解)：
+//   ins k / del k / find k / range lo hi / print
+// 二進位格式以 "HW6C" 開頭，之後每個指令為 1 byte 的操作碼加上 little-endian int32 參數
+// (range 兩個參數、print 沒有參數)
+namespace driver {
+
+    enum class Op : uint8_t { Insert = 1, Remove = 2, Find = 3, Range = 4, Print = 5 };
+    constexpr int kOpCount = 6;
+    constexpr const char* kOpNames[kOpCount] = { "", "ins", "del", "find", "range", "print" };
+    constexpr char kBinaryMagic[4] = { 'H', 'W', '6', 'C' };
+
+    struct Command {
+        Op op;
+        int a = 0;
+        int b = 0;
+    };
+
+    // 以大區塊讀取輸入，直接在緩衝區上解析，不為每行配置字串
+    class CommandReader {
+        std::FILE* in;
+        std::vector<char> buffer;
+        size_t pos = 0, end = 0;
+        bool eof = false;
+        bool binary = false;
+
+        // 確保緩衝區內至少有 n 個未處理的位元組 (到檔尾時可能不足)
+        bool fill(size_t n) {
+            while (end - pos < n && !eof) {
+                if (pos > 0) { // 將未處理的尾段搬到開頭
+                    std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+                    end -= pos;
+                    pos = 0;
+                }
+                if (end == buffer.size()) buffer.resize(buffer.size() * 2); // 單行超過緩衝區時擴大
+                size_t got = std::fread(buffer.data() + end, 1, buffer.size() - end, in);
+                end += got;
+                if (got == 0) eof = true;
+            }
+            return end - pos >= n;
+        }
+
+        int32_t readInt32(size_t offset) const {
+            uint8_t bytes[4];
+            std::memcpy(bytes, buffer.data() + pos + offset, 4);
+            return static_cast<int32_t>(bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24);
+        }
+
+        bool nextBinary(Command& cmd) {
+            if (!fill(1)) return false;
+            uint8_t code = static_cast<uint8_t>(buffer[pos]);
+            if (code < 1 || code >= kOpCount) {
+                errors++;
+                pos = end; // 二進位串流無法重新同步，直接結束
+                eof = true;
+                return false;
+            }
+            cmd.op = static_cast<Op>(code);
+            size_t args = cmd.op == Op::Range ? 2 : cmd.op == Op::Print ? 0 : 1;
+            if (!fill(1 + 4 * args)) {
+                errors++;
+                pos = end;
+                return false;
+            }
+            if (args > 0) cmd.a = readInt32(1);
+            if (args > 1) cmd.b = readInt32(5);
+            pos += 1 + 4 * args;
+            return true;
+        }
+
+        // 解析 [p, last) 中的一個整數並前移 p
+        static bool parseInt(const char*& p, const char* last, int& value) {
+            while (p < last && (*p == ' ' || *p == '\t')) p++;
+            auto result = std::from_chars(p, last, value);
+            if (result.ec != std::errc()) return false;
+            p = result.ptr;
+            return true;
+        }
+
+        bool parseLine(const char* p, const char* last, Command& cmd) {
+            while (p < last && (*p == ' ' || *p == '\t')) p++;
+            const char* word = p;
+            while (p < last && *p != ' ' && *p != '\t') p++;
+            size_t length = p - word;
+            int op = 1;
+            while (op < kOpCount && (std::strlen(kOpNames[op]) != length || std::memcmp(kOpNames[op], word, length) != 0)) op++;
+            if (op == kOpCount) return false;
+
+            cmd.op = static_cast<Op>(op);
+            if (cmd.op != Op::Print && !parseInt(p, last, cmd.a)) return false;
+            if (cmd.op == Op::Range && !parseInt(p, last, cmd.b)) return false;
+            while (p < last && (*p == ' ' || *p == '\t')) p++;
+            return p == last; // 不允許多餘的內容
+        }
+
+        bool nextText(Command& cmd) {
+            while (true) {
+                if (!fill(1)) return false;
+                const char* start = buffer.data() + pos;
+                const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - pos));
+                while (!newline && !eof) { // 行尚未讀完，讀入更多資料
+                    size_t scanned = end - pos;
+                    fill(scanned + 1);
+                    start = buffer.data() + pos;
+                    newline = static_cast<const char*>(std::memchr(start + scanned, '\n', end - pos - scanned));
+                }
+                const char* last = newline ? newline : buffer.data() + end;
+                pos = (last - buffer.data()) + (newline ? 1 : 0);
+                line++;
+
+                const char* comment = static_cast<const char*>(std::memchr(start, '#', last - start));
+                if (comment) last = comment;
+                while (last > start && (last[-1] == '\r' || last[-1] == ' ' || last[-1] == '\t')) last--;
+                const char* first = start;
+                while (first < last && (*first == ' ' || *first == '\t')) first++;
+                if (first == last) continue; // 空行或註解
+
+                if (parseLine(first, last, cmd)) return true;
+                errors++;
+                std::cerr << "第 " << line << " 行無法解析: " << std::string(first, last) << "\n";
+            }
+        }
+
+    public:
+        size_t line = 0; // 文字模式下目前的行號
+        size_t errors = 0; // 無法解析的指令數
+
+        explicit CommandReader(std::FILE* in, size_t bufferSize = 1 << 20) : in(in), buffer(bufferSize) {
+            if (fill(sizeof(kBinaryMagic)) && std::memcmp(buffer.data(), kBinaryMagic, sizeof(kBinaryMagic)) == 0) {
+                binary = true;
+                pos += sizeof(kBinaryMagic);
+            }
+        }
+
+        bool isBinary() const { return binary; }
+
+        // 讀取下一個指令，串流結束時回傳 false
+        bool next(Command& cmd) {
+            cmd = Command();
+            return binary ? nextBinary(cmd) : nextText(cmd);
+        }
+    };
+
+    // 每種指令的延遲樣本 (奈秒)
+    struct LatencyStats {
+        std::vector<uint32_t> samples[kOpCount];
+
+        void add(Op op, uint64_t nanos) {
+            samples[static_cast<int>(op)].push_back(static_cast<uint32_t>(std::min<uint64_t>(nanos, UINT32_MAX)));
+        }
+
+        static uint32_t percentile(std::vector<uint32_t>& sorted, double p) {
+            size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+            return sorted[index];
+        }
+
+        void report(std::ostream& out) {
+            out << std::left << std::setw(8) << "op" << std::right << std::setw(12) << "count"
+                << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+                << std::setw(10) << "p99.9" << std::setw(12) << "max" << "  (ns)\n";
+            for (int op = 1; op < kOpCount; op++) {
+                std::vector<uint32_t>& s = samples[op];
+                if (s.empty()) continue;
+                std::sort(s.begin(), s.end());
+                out << std::left << std::setw(8) << kOpNames[op] << std::right << std::setw(12) << s.size()
+                    << std::setw(10) << percentile(s, 0.5) << std::setw(10) << percentile(s, 0.9)
+                    << std::setw(10) << percentile(s, 0.99) << std::setw(10) << percentile(s, 0.999)
+                    << std::setw(12) << s.back() << "\n";
+            }
+        }
+    };
+
+    // 對樹執行整個指令串流；echo 為 true 時輸出 find 與 range 的結果，showStats 為 true 時最後輸出結構統計
+    template <typename Tree>
+    void run(Tree& tree, CommandReader& reader, bool echo, std::ostream& out, bool showStats = false) {
+        using Clock = std::chrono::steady_clock;
+        LatencyStats stats;
+        size_t commands = 0, found = 0;
+        long long rangeKeys = 0;
+        Command cmd;
+
+        auto begin = Clock::now();
+        while (reader.next(cmd)) {
+            bool hit = false;
+            long long count = 0;
+            auto start = Clock::now();
+            switch (cmd.op) {
+            case Op::Insert:
+                tree.insert(cmd.a);
+                break;
+            case Op::Remove:
+                tree.remove(cmd.a);
+                break;
+            case Op::Find:
+                hit = tree.contains(cmd.a);
+                break;
+            case Op::Range:
+                tree.forEachInRange(cmd.a, cmd.b, [&](int) { count++; });
+                break;
+            case Op::Print:
+                tree.printTree();
+                break;
+            }
+            stats.add(cmd.op, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+            commands++;
+
+            // 結果輸出不計入延遲
+            if (cmd.op == Op::Find) {
+                found += hit;
+                if (echo) out << "find " << cmd.a << ": " << (hit ? "found" : "not found") << "\n";
+            }
+            else if (cmd.op == Op::Range) {
+                rangeKeys += count;
+                if (echo) out << "range " << cmd.a << " " << cmd.b << ": " << count << "\n";
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        out << "\n共執行 " << commands << " 個指令 (" << (reader.isBinary() ? "二進位" : "文字") << "格式)，耗時 "
+            << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms，吞吐量 "
+            << std::setprecision(0) << (seconds > 0 ? commands / seconds : 0.0) << " ops/s\n";
+        out << std::defaultfloat << std::setprecision(6); // 還原格式，後面的統計才不會被取整
+        out << "find 命中 " << found << " 次，range 共涵蓋 " << rangeKeys << " 個鍵值";
+        if (reader.errors) out << "，" << reader.errors << " 個指令無法解析";
+        out << "\n";
+        stats.report(out);
+        if (showStats) out << "\n" << tree.opStats() << tree.shapeStats() << tree.memoryUsage();
+    }
+
+    // 執行完指令後依 format (levels、dot 或 json) 輸出整棵樹
+    template <typename Tree>
+    void dump(const Tree& tree, const std::string& format, std::ostream& out, const render::Limits& limits) {
+        if (format == "levels") tree.printLevels(out, limits);
+        else if (format == "dot") tree.exportDot(out, limits);
+        else tree.exportJson(out, limits);
+    }
+
+    // 把整個參數解析為非負整數；格式不對或超出範圍時回傳 false
+    template <class T>
+    bool parseCount(const char* text, T& value) {
+        const char* last = text + std::strlen(text);
+        auto result = std::from_chars(text, last, value);
+        return result.ec == std::errc() && result.ptr == last && value >= 0;
+    }
+
+    // hw6 --run <檔案|-> [--tree btree|mway] [--order n] [--echo] [--stats] [--filter]
+    //               [--dump levels|dot|json] [--dump-to 檔案] [--depth d] [--width w] [--keys k]
+    // --order 為 BTree 的最小度數 t 或 MWayTree 的階數 m；--dump 在最後輸出整棵樹 (預設寫到標準輸出)，
+    // --depth / --width / --keys 限制輸出的層數、每層的節點數與每個節點的鍵值數；
+    // --filter 為 BTree 啟用 membership filter，find / del 不存在的鍵值時大多不必走訪樹
+    inline int runDriver(int argc, char* argv[]) {
+        std::ios::sync_with_stdio(false); // 輸出改為緩衝，避免每個鍵值的訊息都直接寫出
+        std::string path = argc > 2 ? argv[2] : "-";
+        std::string treeType = "btree";
+        int order = 32;
+        bool echo = false;
+        bool showStats = false;
+        bool useFilter = false;
+        std::string dumpFormat, dumpPath;
+        render::Limits limits;
+        for (int i = 3; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--tree" && i + 1 < argc) treeType = argv[++i];
+            else if (arg == "--order" && i + 1 < argc) {
+                if (!parseCount(argv[++i], order)) {
+                    std::cerr << "--order 需要非負整數: " << argv[i] << "\n";
+                    return 1;
+                }
+            }
+            else if (arg == "--echo") echo = true;
+            else if (arg == "--stats") showStats = true;
+            else if (arg == "--filter") useFilter = true;
+            else if (arg == "--dump" && i + 1 < argc) dumpFormat = argv[++i];
+            else if (arg == "--dump-to" && i + 1 < argc) dumpPath = argv[++i];
+            else if (arg == "--depth" && i + 1 < argc) {
+                if (!parseCount(argv[++i], limits.maxDepth)) {
+                    std::cerr << "--depth 需要非負整數: " << argv[i] << "\n";
+                    return 1;
+                }
+            }
+            else if (arg == "--width" && i + 1 < argc) {
+                if (!parseCount(argv[++i], limits.maxNodesPerLevel)) {
+                    std::cerr << "--width 需要非負整數: " << argv[i] << "\n";
+                    return 1;
+                }
+            }
+            else if (arg == "--keys" && i + 1 < argc) {
+                if (!parseCount(argv[++i], limits.maxKeysPerNode)) {
+                    std::cerr << "--keys 需要非負整數: " << argv[i] << "\n";
+                    return 1;
+                }
+            }
+            else {
+                std::cerr << "未知的參數: " << arg << "\n";
+                return 1;
+            }
+        }
+        if (treeType != "btree" && treeType != "mway") {
+            std::cerr << "--tree 只能是 btree 或 mway\n";
+            return 1;
+        }
+        if (useFilter && treeType != "btree") {
+            std::cerr << "--filter 只適用於 btree\n";
+            return 1;
+        }
+        if (order < (treeType == "btree" ? 2 : 3)) {
+            std::cerr << "--order 太小\n";
+            return 1;
+        }
+        if (!dumpFormat.empty() && dumpFormat != "levels" && dumpFormat != "dot" && dumpFormat != "json") {
+            std::cerr << "--dump 只能是 levels、dot 或 json\n";
+            return 1;
+        }
+        std::ofstream dumpFile;
+        if (!dumpPath.empty()) {
+            dumpFile.open(dumpPath, std::ios::binary);
+            if (!dumpFile) {
+                std::cerr << "無法寫入: " << dumpPath << "\n";
+                return 1;
+            }
+        }
+        std::ostream& dumpOut = dumpPath.empty() ? std::cout : dumpFile;
+
+#ifdef _WIN32
+        if (path == "-") _setmode(_fileno(stdin), _O_BINARY); // 二進位串流不可經過換行轉換
+#endif
+        std::FILE* in = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+        if (!in) {
+            std::cerr << "無法開啟指令檔: " << path << "\n";
+            return 1;
+        }
+
+        CommandReader reader(in);
+        if (treeType == "btree") {
+            BTree tree(order);
+            tree.setReportMissing(false); // 不存在的鍵值不逐一輸出，以免輸出成為主要成本
+            if (useFilter) tree.enableMembershipFilter();
+            run(tree, reader, echo, std::cout, showStats);
+            if (!dumpFormat.empty()) dump(tree, dumpFormat, dumpOut, limits);
+        }
+        else {
+            MWayTree tree(order);
+            run(tree, reader, echo, std::cout, showStats);
+            if (!dumpFormat.empty()) dump(tree, dumpFormat, dumpOut, limits);
+        }
+        std::cout.flush();
+        if (in != stdin) std::fclose(in);
+        return reader.errors ? 2 : 0;
+    }
+}
@@ -0,0 +1,262 @@
+﻿#pragma once
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include "NodeSearch.h"
+
+// 多執行緒 B-tree (optimistic lock coupling)：
+// - 每個節點有一個版本號，第 1 位元表示寫入鎖，每次解鎖版本號加 2
+// - 讀取者不加鎖，讀完節點後再確認版本號未變，否則從根節點重來
+// - 寫入者沿用 insertNonFull 的預先分裂，只在修改的節點 (及其父節點) 上鎖
+// 鍵值全部存放在葉節點 (B+-tree 結構)，刪除只需鎖定一個葉節點；節點不合併，
+// 因此讀取者手上的節點指標永遠有效，不需要額外的記憶體回收機制
+template <int T>
+class ConcurrentBTree {
+    static_assert(T >= 2, "ConcurrentBTree 的最小度數至少為 2");
+    static constexpr int MaxKeys = 2 * T - 1;
+
+    struct alignas(64) Node {
+        std::atomic<uint64_t> version; // 版本號，bit 1 為寫入鎖
+        bool leaf;
+        int count; // 目前的鍵值數
+        int keys[MaxKeys]; // 葉節點為資料鍵值；內部節點為分隔鍵 (左子樹的最大鍵值)
+        Node* children[MaxKeys + 1];
+
+        explicit Node(bool leaf) : version(4), leaf(leaf), count(0) {}
+
+        // 讀取前取得版本號；節點被鎖定時要求重來
+        uint64_t readLockOrRestart(bool& needRestart) const {
+            uint64_t v = version.load(std::memory_order_acquire);
+            if (v & 2) {
+                std::this_thread::yield();
+                needRestart = true;
+            }
+            return v;
+        }
+
+        // 讀取後確認版本號未變
+        void checkOrRestart(uint64_t v, bool& needRestart) const {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) != v) needRestart = true;
+        }
+
+        // 從讀取狀態升級為寫入鎖，期間若有人修改過則失敗
+        void upgradeToWriteLockOrRestart(uint64_t& v, bool& needRestart) {
+            if (version.compare_exchange_strong(v, v + 2, std::memory_order_acquire)) {
+                std::atomic_thread_fence(std::memory_order_release); // 鎖定位元必須先於之後的資料寫入被看見
+                v += 2;
+            }
+            else {
+                std::this_thread::yield();
+                needRestart = true;
+            }
+        }
+
+        void writeUnlock() {
+            version.fetch_add(2, std::memory_order_release);
+        }
+
+        // 節點內第一個不小於 key 的位置；版本號驗證前 count 可能不一致，因此先夾在合法範圍內
+        int lowerBound(int key) const {
+            return nodesearch::rank(keys, std::min(std::max(count, 0), MaxKeys), key);
+        }
+    };
+
+    std::atomic<Node*> root;
+
+    // 分裂已鎖定的已滿節點，回傳新的右半節點，separator 為要放入父節點的分隔鍵
+    Node* split(Node* node, int& separator) {
+        Node* right = new Node(node->leaf);
+        if (node->leaf) { // 葉節點：左邊保留 T 個鍵值，分隔鍵為左邊的最大值
+            right->count = MaxKeys - T;
+            std::copy(node->keys + T, node->keys + MaxKeys, right->keys);
+            node->count = T;
+            separator = node->keys[T - 1];
+        }
+        else { // 內部節點：中間鍵值上移
+            right->count = MaxKeys - T;
+            std::copy(node->keys + T, node->keys + MaxKeys, right->keys);
+            std::copy(node->children + T, node->children + MaxKeys + 1, right->children);
+            node->count = T - 1;
+            separator = node->keys[T - 1];
+        }
+        return right;
+    }
+
+    // 在已鎖定的內部節點中插入分隔鍵與右子節點
+    static void insertSeparator(Node* parent, int separator, Node* right) {
+        int pos = parent->lowerBound(separator);
+        std::copy_backward(parent->keys + pos, parent->keys + parent->count, parent->keys + parent->count + 1);
+        std::copy_backward(parent->children + pos + 1, parent->children + parent->count + 1, parent->children + parent->count + 2);
+        parent->keys[pos] = separator;
+        parent->children[pos + 1] = right;
+        parent->count++;
+    }
+
+    // 分裂 node (必要時連同父節點一起鎖定)；成功與否呼叫端都要從根節點重來
+    void splitWithParent(Node* parent, uint64_t& versionParent, Node* node, uint64_t& versionNode, bool& needRestart) {
+        if (parent) {
+            parent->upgradeToWriteLockOrRestart(versionParent, needRestart);
+            if (needRestart) return;
+        }
+        node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+        if (needRestart) {
+            if (parent) parent->writeUnlock();
+            return;
+        }
+        if (!parent && node != root.load(std::memory_order_acquire)) { // 根節點已被其他執行緒換掉
+            node->writeUnlock();
+            needRestart = true;
+            return;
+        }
+
+        int separator;
+        Node* right = split(node, separator);
+        if (parent) {
+            insertSeparator(parent, separator, right);
+        }
+        else { // 分裂根節點，樹高加一
+            Node* newRoot = new Node(false);
+            newRoot->count = 1;
+            newRoot->keys[0] = separator;
+            newRoot->children[0] = node;
+            newRoot->children[1] = right;
+            root.store(newRoot, std::memory_order_release);
+        }
+        node->writeUnlock();
+        if (parent) parent->writeUnlock();
+        needRestart = true; // 結構已改變，重新往下走
+    }
+
+    // 以樂觀讀取走到 key 所在的葉節點；回傳時葉節點尚未驗證，父節點已驗證
+    Node* descend(int key, uint64_t& versionLeaf, bool& needRestart) const {
+        Node* node = root.load(std::memory_order_acquire);
+        uint64_t versionNode = node->readLockOrRestart(needRestart);
+        if (needRestart || node != root.load(std::memory_order_acquire)) {
+            needRestart = true;
+            return nullptr;
+        }
+        while (!node->leaf) {
+            Node* child = node->children[node->lowerBound(key)];
+            node->checkOrRestart(versionNode, needRestart);
+            if (needRestart) return nullptr;
+            uint64_t versionChild = child->readLockOrRestart(needRestart);
+            if (needRestart) return nullptr;
+            node->checkOrRestart(versionNode, needRestart); // 確認讀到的子節點仍屬於此父節點
+            if (needRestart) return nullptr;
+            node = child;
+            versionNode = versionChild;
+        }
+        versionLeaf = versionNode;
+        return node;
+    }
+
+    static void freeNodes(Node* node) {
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; i++) freeNodes(node->children[i]);
+        }
+        delete node;
+    }
+
+public:
+    ConcurrentBTree() : root(new Node(true)) {}
+    ~ConcurrentBTree() { freeNodes(root.load()); }
+    ConcurrentBTree(const ConcurrentBTree&) = delete;
+    ConcurrentBTree& operator=(const ConcurrentBTree&) = delete;
+
+    // 插入鍵值，鍵值已存在時回傳 false；可與其他執行緒的任何操作同時呼叫
+    bool insert(int key) {
+        while (true) {
+            bool needRestart = false;
+            Node* node = root.load(std::memory_order_acquire);
+            uint64_t versionNode = node->readLockOrRestart(needRestart);
+            if (needRestart || node != root.load(std::memory_order_acquire)) continue;
+
+            Node* parent = nullptr;
+            uint64_t versionParent = 0;
+
+            while (true) {
+                if (node->count == MaxKeys) { // 與 insertNonFull 相同，路上遇到已滿的節點先分裂
+                    splitWithParent(parent, versionParent, node, versionNode, needRestart);
+                    break;
+                }
+                if (parent) {
+                    parent->checkOrRestart(versionParent, needRestart);
+                    if (needRestart) break;
+                }
+                if (node->leaf) break;
+
+                Node* child = node->children[node->lowerBound(key)];
+                node->checkOrRestart(versionNode, needRestart);
+                if (needRestart) break;
+                uint64_t versionChild = child->readLockOrRestart(needRestart);
+                if (needRestart) break;
+
+                parent = node;
+                versionParent = versionNode;
+                node = child;
+                versionNode = versionChild;
+            }
+            if (needRestart) continue;
+
+            // 到達未滿的葉節點，只鎖定它本身
+            node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+            if (needRestart) continue;
+            if (parent) {
+                parent->checkOrRestart(versionParent, needRestart);
+                if (needRestart) {
+                    node->writeUnlock();
+                    continue;
+                }
+            }
+
+            int pos = node->lowerBound(key);
+            bool inserted = !(pos < node->count && node->keys[pos] == key);
+            if (inserted) {
+                std::copy_backward(node->keys + pos, node->keys + node->count, node->keys + node->count + 1);
+                node->keys[pos] = key;
+                node->count++;
+            }
+            node->writeUnlock();
+            return inserted;
+        }
+    }
+
+    // 刪除鍵值，找不到時回傳 false；葉節點允許低於半滿，不做合併
+    bool remove(int key) {
+        while (true) {
+            bool needRestart = false;
+            uint64_t versionLeaf;
+            Node* leaf = descend(key, versionLeaf, needRestart);
+            if (needRestart) continue;
+
+            leaf->upgradeToWriteLockOrRestart(versionLeaf, needRestart);
+            if (needRestart) continue;
+
+            int pos = leaf->lowerBound(key);
+            bool found = pos < leaf->count && leaf->keys[pos] == key;
+            if (found) {
+                std::copy(leaf->keys + pos + 1, leaf->keys + leaf->count, leaf->keys + pos);
+                leaf->count--;
+            }
+            leaf->writeUnlock();
+            return found;
+        }
+    }
+
+    // 判斷鍵值是否存在；全程不加鎖，版本號改變時重來
+    bool contains(int key) const {
+        while (true) {
+            bool needRestart = false;
+            uint64_t versionLeaf;
+            Node* leaf = descend(key, versionLeaf, needRestart);
+            if (needRestart) continue;
+
+            int pos = leaf->lowerBound(key);
+            bool found = pos < std::min(leaf->count, MaxKeys) && leaf->keys[pos] == key;
+            leaf->checkOrRestart(versionLeaf, needRestart);
+            if (!needRestart) return found;
+        }
+    }
+};
@@ -0,0 +1,220 @@
+﻿#pragma once
+#include <vector>
+#include <string>
+#include <span>
+#include <fstream>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <bit>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "NodeSearch.h"
+
+// 凍結後的唯讀索引：所有鍵值依 Eytzinger (BFS) 順序存放在一個對齊快取線、不含指標的連續陣列中，
+// 位置 k 的左右子節點為 2k 與 2k+1 (由 1 起算)，搜尋時只需計算下標，不必追蹤指標；
+// 往下 4 層的 16 個子孫恰好佔同一條 64 位元組的快取線，可以提前預取
+class FrozenIndex {
+    struct AlignedDelete {
+        void operator()(int* p) const {
+            ::operator delete[](p, std::align_val_t(64));
+        }
+    };
+
+    std::unique_ptr<int[], AlignedDelete> data; // data[1..n]，data[0] 不使用
+    size_t n = 0;
+    int levels = 0; // 樹的層數 (最後一層可能不滿)
+
+    static constexpr char kMagic[4] = { 'H', 'W', '6', 'F' };
+    static constexpr uint32_t kVersion = 1;
+
+    // 檔案開頭，之後緊接 count 個 int (Eytzinger 順序)
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t count;
+    };
+
+    void allocate(size_t count) {
+        n = count;
+        levels = static_cast<int>(std::bit_width(n));
+        data.reset(static_cast<int*>(::operator new[]((n + 1) * sizeof(int), std::align_val_t(64))));
+        data[0] = 0;
+    }
+
+    // 以中序走訪把已排序的鍵值依序填入 Eytzinger 位置
+    size_t fill(const int* sorted, size_t i, size_t k) {
+        if (k > n) return i;
+        i = fill(sorted, i, 2 * k);
+        data[k] = sorted[i++];
+        return fill(sorted, i, 2 * k + 1);
+    }
+
+    // 預取位置 k 往下 4 層的子孫 (16k ~ 16k+15)；只是提示，位址超出陣列也不會發生錯誤
+    void prefetch(size_t k) const {
+        const char* address = reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(data.get()) + 16 * k * sizeof(int));
+#ifdef HW6_X86
+        _mm_prefetch(address, _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    // 最後一次往右之前所在的位置：去掉結尾連續的 1 與其前面的一個 0 (k 為 0 表示不存在)
+    static size_t settle(size_t k) {
+        return k >> (std::countr_one(k) + 1);
+    }
+
+    // 第一個不小於 key 的鍵值所在位置；每層只做一次比較並把結果併入下標，迴圈內沒有依資料而定的分支
+    size_t lowerBoundIndex(int key) const {
+        size_t k = 1;
+        while (k <= n) {
+            prefetch(k);
+            k = 2 * k + (data[k] < key);
+        }
+        return settle(k);
+    }
+
+    // 一次處理 Group 個查詢，逐層輪流前進：一個查詢等待記憶體時，其他查詢的預取已經在進行
+    template <size_t Group>
+    void lowerBoundGroup(const int* queries, size_t count, size_t* out) const {
+        size_t k[Group];
+        for (size_t j = 0; j < count; j++) k[j] = 1;
+        for (int level = 0; level + 1 < levels; level++) { // 前 levels-1 層是滿的，每個下標都有效
+            for (size_t j = 0; j < count; j++) {
+                prefetch(k[j]);
+                k[j] = 2 * k[j] + (data[k[j]] < queries[j]);
+            }
+        }
+        for (size_t j = 0; j < count; j++) { // 最後一層可能不滿，超出 n 的位置不再往下
+            size_t index = std::min(k[j], n);
+            size_t next = 2 * k[j] + (data[index] < queries[j]);
+            out[j] = settle(k[j] <= n ? next : k[j]);
+        }
+    }
+
+    template <typename Fn>
+    void forEachBatch(std::span<const int> queries, Fn fn) const {
+        constexpr size_t Group = 16;
+        size_t index[Group];
+        for (size_t start = 0; start < queries.size(); start += Group) {
+            size_t count = std::min(Group, queries.size() - start);
+            if (n == 0) std::fill(index, index + count, size_t(0));
+            else lowerBoundGroup<Group>(queries.data() + start, count, index);
+            for (size_t j = 0; j < count; j++) fn(start + j, index[j]);
+        }
+    }
+
+public:
+    FrozenIndex() = default;
+
+    // 由鍵值建立索引：輸入不需事先排序，已排序時省略排序步驟 (與 bulkLoad 相同)；允許重複鍵值
+    template <typename InputIt>
+    FrozenIndex(InputIt first, InputIt last) {
+        std::vector<int> keys(first, last);
+        if (!std::is_sorted(keys.begin(), keys.end())) std::sort(keys.begin(), keys.end());
+        allocate(keys.size());
+        fill(keys.data(), 0, 1);
+    }
+
+    FrozenIndex(FrozenIndex&&) noexcept = default;
+    FrozenIndex& operator=(FrozenIndex&&) noexcept = default;
+
+    size_t size() const {
+        return n;
+    }
+
+    bool empty() const {
+        return n == 0;
+    }
+
+    // 索引佔用的位元組數 (即寫入檔案的資料大小)
+    size_t bytes() const {
+        return n * sizeof(int);
+    }
+
+    // 第一個不小於 key 的鍵值，不存在時回傳 nullptr
+    const int* lower_bound(int key) const {
+        size_t k = lowerBoundIndex(key);
+        return k ? &data[k] : nullptr;
+    }
+
+    // 查詢鍵值，找到時回傳指向該鍵值的指標，否則回傳 nullptr
+    const int* find(int key) const {
+        const int* p = lower_bound(key);
+        return p && *p == key ? p : nullptr;
+    }
+
+    bool contains(int key) const {
+        return find(key) != nullptr;
+    }
+
+    // 批次 lower_bound：results[i] 對應 queries[i]
+    void lowerBoundBatch(std::span<const int> queries, std::span<const int*> results) const {
+        forEachBatch(queries, [&](size_t i, size_t k) { results[i] = k ? &data[k] : nullptr; });
+    }
+
+    // 批次 find：results[i] 對應 queries[i]，回傳找到的個數
+    size_t findBatch(std::span<const int> queries, std::span<const int*> results) const {
+        size_t found = 0;
+        forEachBatch(queries, [&](size_t i, size_t k) {
+            bool hit = k && data[k] == queries[i];
+            results[i] = hit ? &data[k] : nullptr;
+            found += hit;
+        });
+        return found;
+    }
+
+    // 依序對每個鍵值呼叫 fn (Eytzinger 陣列的中序走訪)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        if (n == 0) return;
+        size_t k = 1;
+        while (2 * k <= n) k *= 2; // 最左邊的節點
+        while (k) {
+            fn(data[k]);
+            if (2 * k + 1 <= n) { // 有右子樹：走到右子樹最左邊
+                k = 2 * k + 1;
+                while (2 * k <= n) k *= 2;
+            }
+            else { // 往上直到從左子樹返回
+                k = settle(k);
+            }
+        }
+    }
+
+    // 將陣列原封不動寫入檔案，成功時回傳 true
+    bool save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        FileHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.count = n;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (n) out.write(reinterpret_cast<const char*>(&data[1]), static_cast<std::streamsize>(bytes()));
+        return static_cast<bool>(out);
+    }
+
+    // 由 save 產生的檔案直接讀回陣列，不需重新排序或重排；檔案不存在或格式錯誤時回傳 false，索引保持為空
+    bool load(const std::string& path) {
+        *this = FrozenIndex();
+        std::ifstream in(path, std::ios::binary);
+        FileHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) return false;
+        in.seekg(0, std::ios::end);
+        uint64_t payload = static_cast<uint64_t>(in.tellg()) - sizeof(header);
+        // 先用除法比較，count 過大時相乘會溢位而讓檢查誤判通過
+        if (header.count > payload / sizeof(int) || payload != header.count * sizeof(int)) return false;
+        in.seekg(sizeof(header));
+        FrozenIndex loaded;
+        loaded.allocate(static_cast<size_t>(header.count));
+        if (loaded.n && !in.read(reinterpret_cast<char*>(&loaded.data[1]), static_cast<std::streamsize>(loaded.bytes()))) return false;
+        *this = std::move(loaded);
+        return true;
+    }
+};
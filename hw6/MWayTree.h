@@ -0,0 +1,551 @@
+﻿#pragma once
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "BulkLoad.h"
+#include "NodeSearch.h"
+#include "NodePool.h"
+#include "Snapshot.h"
+#include "TreeStats.h"
+#include "TreeRender.h"
+
+// m-way 搜尋樹的節點結構
+struct MWayNode {
+    int m; // 每個節點最多的鍵值數量
+    std::vector<int> keys; // 儲存節點內的鍵值
+    std::vector<MWayNode*> children; // 儲存子節點的指標
+
+    // 節點的構造函式，初始化鍵值和子節點數量
+    MWayNode(int m) : m(m) {
+        keys.reserve(m - 1); // 預留鍵值的儲存空間
+        children.resize(m, nullptr); // 初始化子節點指標的空間
+    }
+
+    // 由 NodePool 重複使用節點時重新初始化，保留 keys 的容量
+    void reset(int m) {
+        this->m = m;
+        keys.clear();
+        keys.reserve(m - 1); // compact 可能已釋放閒置節點的緩衝區
+        children.assign(m, nullptr);
+    }
+};
+
+// m-way 搜尋樹類別
+class MWayTree {
+    MWayNode* root; // 樹的根節點
+    int m; // 每個節點的階數
+    NodePool<MWayNode> pool; // 所有節點皆由此配置
+    mutable OpStats stats; // 結構操作計數 (find 為 const 也需更新)
+    bool compacting = false; // compact 的一輪是否進行到一半
+    int compactCursor = INT32_MIN; // 進行中的一輪已處理完的子樹都落在此鍵值 (含) 之前
+
+    // 獲取節點中某鍵值的前驅鍵值
+    // m = 3 時分裂會產生沒有鍵值的節點，因此取路徑上最深的非空節點
+    int getPredecessor(MWayNode* node, int index) {
+        HW6_COUNT(getPredecessor);
+        MWayNode* current = node->children[index]; // 進入左子節點
+        int pred = current->keys.empty() ? node->keys[index] : current->keys.back();
+        while (current->children[0]) { // 不斷進入右子節點，找到最大鍵值
+            current = current->children[current->keys.size()];
+            if (!current->keys.empty()) pred = current->keys.back();
+        }
+        return pred; // 返回前驅鍵值
+    }
+
+    // 獲取節點中某鍵值的後繼鍵值
+    int getSuccessor(MWayNode* node, int index) {
+        HW6_COUNT(getSuccessor);
+        MWayNode* current = node->children[index + 1]; // 進入右子節點
+        int succ = current->keys.empty() ? node->keys[index] : current->keys.front();
+        while (current->children[0]) { // 不斷進入左子節點，找到最小鍵值
+            current = current->children[0];
+            if (!current->keys.empty()) succ = current->keys.front();
+        }
+        return succ; // 返回後繼鍵值
+    }
+
+    // 刪除時子節點至少要有的鍵值數，取 m/2 可保證兩個不足的兄弟合併後不超過 m-1 個鍵值
+    int fillThreshold() const {
+        return std::max(1, m / 2);
+    }
+
+    // 處理子節點數量不足的情況
+    void fill(MWayNode* node, int index) {
+        if (node->keys.empty()) return; // m = 3 時分裂會產生沒有鍵值的節點，唯一的子節點沒有兄弟可借用或合併
+        if (index != 0 && static_cast<int>(node->children[index - 1]->keys.size()) >= fillThreshold()) {
+            borrowFromPrev(node, index); // 從左兄弟借用鍵值
+        }
+        else if (index != static_cast<int>(node->keys.size()) && static_cast<int>(node->children[index + 1]->keys.size()) >= fillThreshold()) {
+            borrowFromNext(node, index); // 從右兄弟借用鍵值
+        }
+        else {
+            if (index != static_cast<int>(node->keys.size())) {
+                merge(node, index); // 合併當前節點與右兄弟
+            }
+            else {
+                merge(node, index - 1); // 合併當前節點與左兄弟
+            }
+        }
+    }
+
+    // 從左兄弟借用鍵值
+    void borrowFromPrev(MWayNode* node, int index) {
+        HW6_COUNT(borrowFromPrev);
+        MWayNode* child = node->children[index]; // 當前節點的子節點
+        MWayNode* sibling = node->children[index - 1]; // 左兄弟節點
+
+        // 從父節點中借用鍵值並插入到當前子節點
+        child->keys.insert(child->keys.begin(), node->keys[index - 1]);
+        node->keys[index - 1] = sibling->keys.back(); // 更新父節點的鍵值
+        sibling->keys.pop_back(); // 移除左兄弟的最後一個鍵值
+
+        // 更新子節點的子節點指標 (左兄弟最右邊的子節點位於 keys.size() + 1)
+        if (sibling->children[0]) {
+            MWayNode*& moved = sibling->children[sibling->keys.size() + 1];
+            child->children.insert(child->children.begin(), moved);
+            child->children.pop_back(); // 維持 m 個子節點欄位
+            moved = nullptr;
+        }
+    }
+
+    // 從右兄弟借用鍵值
+    void borrowFromNext(MWayNode* node, int index) {
+        HW6_COUNT(borrowFromNext);
+        MWayNode* child = node->children[index]; // 當前節點的子節點
+        MWayNode* sibling = node->children[index + 1]; // 右兄弟節點
+
+        // 從父節點中借用鍵值並插入到當前子節點
+        child->keys.push_back(node->keys[index]);
+        node->keys[index] = sibling->keys[0]; // 更新父節點的鍵值
+        sibling->keys.erase(sibling->keys.begin()); // 移除右兄弟的第一個鍵值
+
+        // 更新子節點的子節點指標 (接在子節點目前最右邊的子節點之後)
+        if (sibling->children[0]) {
+            child->children[child->keys.size()] = sibling->children[0];
+            sibling->children.erase(sibling->children.begin());
+            sibling->children.push_back(nullptr); // 維持 m 個子節點欄位
+        }
+    }
+
+    // 將滿的子節點進行分裂
+    void splitChild(MWayNode* parent, int index) {
+        HW6_COUNT(splitChild);
+        MWayNode* child = parent->children[index]; // 要分裂的子節點
+        MWayNode* newChild = pool.create(m); // 創建一個新節點
+
+        int mid = (m - 1) / 2; // 計算中間鍵值的索引
+        parent->keys.insert(parent->keys.begin() + index, child->keys[mid]); // 將中間鍵值上移到父節點
+
+        // 將右半部分鍵值移動到新節點
+        for (int i = mid + 1; i < m - 1; i++) {
+            newChild->keys.push_back(child->keys[i]);
+        }
+        child->keys.resize(mid); // 調整原子節點的鍵值數量
+
+        // 如果子節點是內部節點，還需要處理子節點的子節點指標
+        if (child->children[0]) {
+            for (int i = mid + 1; i < m; i++) {
+                newChild->children[i - mid - 1] = child->children[i];
+                child->children[i] = nullptr;
+            }
+        }
+
+        parent->children.insert(parent->children.begin() + index + 1, newChild); // 將新節點插入到父節點
+        parent->children.pop_back(); // 父節點未滿，最後一個欄位必為空，移除以維持 m 個欄位
+    }
+
+    // 在非滿節點中插入鍵值
+    void insertNonFull(MWayNode* node, int key) {
+        HW6_COUNT(nodesVisited);
+        int i = static_cast<int>(node->keys.size()) - 1;
+
+        if (!node->children[0]) { // 如果節點是葉節點
+            node->keys.push_back(0); // 暫時擴展空間
+            while (i >= 0 && key < node->keys[i]) { // 從後向前移動鍵值
+                node->keys[i + 1] = node->keys[i];
+                i--;
+            }
+            node->keys[i + 1] = key; // 插入鍵值
+        }
+        else { // 如果節點是內部節點
+            while (i >= 0 && key < node->keys[i]) {
+                i--;
+            }
+            i++;
+
+            if (static_cast<int>(node->children[i]->keys.size()) == m - 1) {
+                splitChild(node, i); // 分裂滿節點
+                if (key > node->keys[i]) {
+                    i++;
+                }
+            }
+            insertNonFull(node->children[i], key); // 遞迴插入到子節點
+        }
+    }
+
+    // 由根往下搜尋鍵值，不計入 operations
+    const int* locate(int key) const {
+        const MWayNode* node = root;
+        while (node) {
+            HW6_COUNT(nodesVisited);
+            int n = static_cast<int>(node->keys.size());
+            int i = nodesearch::rank(node->keys.data(), n, key); // 節點內第一個不小於 key 的位置
+            if (i < n && node->keys[i] == key) return &node->keys[i];
+            node = node->children[i]; // 葉節點的子節點皆為空指標
+        }
+        return nullptr;
+    }
+
+    // 從節點中刪除鍵值
+    void removeFromNode(MWayNode* node, int key) {
+        HW6_COUNT(nodesVisited);
+        int index = static_cast<int>(std::lower_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin());
+
+        if (index < static_cast<int>(node->keys.size()) && node->keys[index] == key) {
+            if (!node->children[0]) { // 如果是葉節點，直接刪除鍵值
+                node->keys.erase(node->keys.begin() + index);
+            }
+            else if (static_cast<int>(node->children[index]->keys.size()) >= fillThreshold()) { // 左子節點鍵值足夠
+                int pred = getPredecessor(node, index); // 找到前驅鍵值
+                node->keys[index] = pred; // 用前驅鍵值替換
+                removeFromNode(node->children[index], pred); // 從子節點中刪除前驅鍵值
+            }
+            else if (static_cast<int>(node->children[index + 1]->keys.size()) >= fillThreshold()) { // 右子節點鍵值足夠
+                int succ = getSuccessor(node, index); // 找到後繼鍵值
+                node->keys[index] = succ; // 用後繼鍵值替換
+                removeFromNode(node->children[index + 1], succ); // 從子節點中刪除後繼鍵值
+            }
+            else { // 左右子節點都不足，合併後再刪除
+                merge(node, index);
+                removeFromNode(node->children[index], key);
+            }
+        }
+        else {
+            if (!node->children[0]) return; // 如果是葉節點，直接返回
+
+            bool atLastChild = (index == static_cast<int>(node->keys.size()));
+
+            if (static_cast<int>(node->children[index]->keys.size()) < fillThreshold()) {
+                fill(node, index); // 處理子節點數量不足的情況
+            }
+
+            if (atLastChild && index > static_cast<int>(node->keys.size())) {
+                removeFromNode(node->children[index - 1], key); // 從左兄弟中刪除
+            }
+            else {
+                removeFromNode(node->children[index], key); // 從右兄弟中刪除
+            }
+        }
+    }
+
+    // 合併節點
+    void merge(MWayNode* parent, int index) {
+        HW6_COUNT(merge);
+        MWayNode* child = parent->children[index]; // 要合併的節點
+        MWayNode* sibling = parent->children[index + 1]; // 右兄弟節點
+
+        child->keys.push_back(parent->keys[index]); // 將父節點的鍵值移入子節點
+        parent->keys.erase(parent->keys.begin() + index); // 從父節點刪除鍵值
+
+        int offset = static_cast<int>(child->keys.size()); // 右兄弟的子節點接在此位置之後
+        for (int key : sibling->keys) {
+            child->keys.push_back(key); // 將右兄弟的鍵值移入子節點
+        }
+
+        for (int i = 0; i <= static_cast<int>(sibling->keys.size()); i++) {
+            child->children[offset + i] = sibling->children[i]; // 將右兄弟的子節點移入子節點
+        }
+
+        parent->children.erase(parent->children.begin() + index + 1); // 刪除右兄弟的指標
+        parent->children.push_back(nullptr); // 維持 m 個子節點欄位
+        pool.destroy(sibling); // 釋放右兄弟的記憶體
+    }
+
+    // 非根節點至少的鍵值數 (與 bulkLoad 相同，子節點數不少於 ceil(m/2))，compact 重新分配子節點時父節點不低於此值
+    int minKeys() const {
+        return (m + 1) / 2 - 1;
+    }
+
+    // 把 node 的所有子節點 (連同其間的分隔鍵) 依序重新均分成較少的節點，讓每個節點接近 target 個鍵值，
+    // node 本身只剩新的分隔鍵 (非根節點至少保留 minKeys 個鍵值)。沿用最左邊的幾個子節點，其餘的歸還 pool，回傳釋放的節點數
+    size_t packChildren(MWayNode* node, int target, bool isRoot) {
+        int count = static_cast<int>(node->keys.size()) + 1;
+        int items = 0; // 所有子節點的「子節點欄位」總數，即鍵值與分隔鍵的總數加一
+        for (int i = 0; i < count; i++) items += static_cast<int>(node->children[i]->keys.size()) + 1;
+        int groups = std::min(count, std::max((items + target) / (target + 1), isRoot ? 1 : minKeys() + 1));
+        if (groups >= count) return 0;
+
+        bool leaf = !node->children[0]->children[0];
+        std::vector<int> keys;
+        std::vector<MWayNode*> below;
+        keys.reserve(items);
+        for (int i = 0; i < count; i++) {
+            MWayNode* child = node->children[i];
+            keys.insert(keys.end(), child->keys.begin(), child->keys.end());
+            if (!leaf) below.insert(below.end(), child->children.begin(), child->children.begin() + child->keys.size() + 1);
+            if (i + 1 < count) keys.push_back(node->keys[i]);
+        }
+
+        node->keys.clear();
+        size_t next = 0, nextChild = 0;
+        for (int g = 0; g < groups; g++) {
+            int size = items / groups + (g < items % groups ? 1 : 0); // 這個節點的子節點欄位數
+            MWayNode* child = node->children[g];
+            child->keys.assign(keys.begin() + next, keys.begin() + next + size - 1);
+            next += size - 1;
+            if (!leaf) {
+                std::fill(child->children.begin(), child->children.end(), nullptr);
+                std::copy(below.begin() + nextChild, below.begin() + nextChild + size, child->children.begin());
+                nextChild += size;
+            }
+            if (g + 1 < groups) node->keys.push_back(keys[next++]);
+        }
+        for (int i = groups; i < count; i++) {
+            pool.destroy(node->children[i]);
+            node->children[i] = nullptr;
+        }
+        HW6_COUNT_N(merge, count - groups);
+        return count - groups;
+    }
+
+    // 以前序走訪 node 子樹中 compactCursor 之後的部分：先重新分配 node 的子節點 (讓它們各自有較多的子節點)，再往下處理每個子節點，
+    // 每重新分配一個子節點消耗一單位 budget。budget 用完時回傳 false，下次由 compactCursor 右邊的子樹繼續；
+    // 每次呼叫至少會處理到一個最底層的內部節點 (progressed)，不會停滯
+    bool compactSubtree(MWayNode* node, bool isRoot, int target, size_t& budget, size_t& freed, bool& progressed) {
+        budget -= std::min(budget, node->keys.size() + 1);
+        freed += packChildren(node, target, isRoot);
+        if (!node->children[0]->children[0]) {
+            progressed = true;
+            return true;
+        }
+        int n = static_cast<int>(node->keys.size());
+        int i = static_cast<int>(std::upper_bound(node->keys.begin(), node->keys.end(), compactCursor) - node->keys.begin());
+        for (; i <= n; i++) {
+            if (budget == 0 && progressed) return false;
+            if (!compactSubtree(node->children[i], false, target, budget, freed, progressed)) return false;
+            if (i < n) compactCursor = node->keys[i]; // 第 i 個子樹已處理完
+        }
+        return true;
+    }
+
+public:
+    // 初始化 m-way 搜尋樹
+    MWayTree(int m) : root(nullptr), m(m) {}
+
+    // 節點由 pool 擁有，解構時隨 pool 一併釋放
+    ~MWayTree() = default;
+    MWayTree(const MWayTree&) = delete;
+    MWayTree& operator=(const MWayTree&) = delete;
+
+    // 清空整棵樹：直接重置 pool，不需逐一走訪節點
+    void clear() {
+        root = nullptr;
+        pool.reset();
+    }
+
+    // 由下而上批次建樹：輸入不需事先排序，已排序時省略排序步驟
+    // fillFactor 為每個節點的目標填充率 (0~1]，整棵樹只建立一次，不做任何分裂
+    template <typename InputIt>
+    void bulkLoad(InputIt first, InputIt last, double fillFactor = 1.0) {
+        std::vector<int> keys(first, last);
+        if (!std::is_sorted(keys.begin(), keys.end())) {
+            std::sort(keys.begin(), keys.end());
+        }
+
+        clear(); // 取代原本的樹
+        if (keys.empty()) return;
+
+        // 非根節點的子節點數介於 ceil(m/2) 與 m 之間
+        int minChildren = (m + 1) / 2;
+        int targetChildren = targetKeyCount(fillFactor, minChildren - 1, m - 1) + 1;
+
+        // 每一層都是「子節點 - 分隔鍵 - 子節點 ...」的序列，葉層的子節點皆為空指標
+        std::vector<MWayNode*> level(keys.size() + 1, nullptr);
+        std::vector<int> separators = std::move(keys);
+
+        while (true) {
+            std::vector<int> sizes = planNodeSizes(static_cast<int>(level.size()), minChildren, m, targetChildren);
+            std::vector<MWayNode*> parents;
+            std::vector<int> parentSeparators;
+            parents.reserve(sizes.size());
+
+            size_t pos = 0;
+            for (size_t g = 0; g < sizes.size(); g++) {
+                MWayNode* node = pool.create(m);
+                for (int j = 0; j < sizes[g]; j++) {
+                    node->children[j] = level[pos + j]; // 葉層時為空指標
+                    if (j + 1 < sizes[g]) node->keys.push_back(separators[pos + j]);
+                }
+                pos += sizes[g];
+                if (g + 1 < sizes.size()) parentSeparators.push_back(separators[pos - 1]); // 組與組之間的鍵值上移
+                parents.push_back(node);
+            }
+
+            if (parents.size() == 1) {
+                root = parents[0];
+                return;
+            }
+            level = std::move(parents);
+            separators = std::move(parentSeparators);
+        }
+    }
+
+    // 將整棵樹以二進位快照寫入檔案，成功時回傳 true
+    bool saveSnapshot(const std::string& path) const {
+        return snapshot::save(path, snapshot::Kind::MWay, m, root, [](const MWayNode* node) { return node->children[0] == nullptr; });
+    }
+
+    // 由快照檔還原整棵樹 (階數改為快照中的值)，節點直接依層序重建，不經過任何分裂
+    // 檔案不存在或格式錯誤時回傳 false，樹保持為空
+    bool loadSnapshot(const std::string& path) {
+        std::vector<char> data;
+        snapshot::Header header;
+        clear();
+        if (!snapshot::readFile(path, data) || !snapshot::readHeader(data, snapshot::Kind::MWay, header)) return false;
+        if (header.degree < 3 || header.degree > snapshot::kMaxDegree) return false; // m = 2 的節點只有一個鍵值，無法分裂
+        m = static_cast<int>(header.degree);
+        bool ok = snapshot::load<MWayNode>(data, header, 0, m - 1, [&](bool) { return pool.create(m); }, root);
+        if (!ok) clear();
+        return ok;
+    }
+
+    // 插入鍵值
+    void insert(int key) {
+        HW6_COUNT(operations);
+        if (!root) {
+            root = pool.create(m); // 如果根節點為空，創建新節點
+            root->keys.push_back(key);
+            return;
+        }
+
+        if (static_cast<int>(root->keys.size()) == m - 1) { // 如果根節點滿，進行分裂
+            MWayNode* newRoot = pool.create(m);
+            newRoot->children[0] = root;
+            splitChild(newRoot, 0);
+            root = newRoot;
+        }
+
+        insertNonFull(root, key); // 插入鍵值
+    }
+
+    // 刪除鍵值；先以唯讀的搜尋確認鍵值存在，不存在的鍵值不會觸發任何合併或借用
+    void remove(int key) {
+        HW6_COUNT(operations);
+        if (!root || !locate(key)) return;
+
+        removeFromNode(root, key);
+
+        if (root->keys.empty() && root->children[0]) { // 如果根節點為空且有子節點
+            MWayNode* oldRoot = root;
+            root = root->children[0];
+            pool.destroy(oldRoot); // 釋放舊根節點的記憶體
+        }
+    }
+
+    // 查詢鍵值，找到時回傳指向該鍵值的指標，否則回傳 nullptr；不會修改樹
+    const int* find(int key) const {
+        HW6_COUNT(operations);
+        return locate(key);
+    }
+
+    // 判斷鍵值是否存在
+    bool contains(int key) const {
+        return find(key) != nullptr;
+    }
+
+    // 樹高 (空樹為 0，只有根節點時為 1)
+    int height() const {
+        int levels = 0;
+        for (const MWayNode* node = root; node; node = node->children[0]) levels++;
+        return levels;
+    }
+
+    // 結構操作計數 (定義 HW6_NO_STATS 時恆為 0)
+    const OpStats& opStats() const {
+        return stats;
+    }
+
+    void resetOpStats() {
+        stats = OpStats();
+    }
+
+    // 樹高、節點數、每層填充率與節點佔用的記憶體
+    ShapeStats shapeStats() const {
+        return computeShape(root, m - 1, [](const MWayNode* node) { return node->children[0] == nullptr; });
+    }
+
+    // 樹上節點與 pool 中閒置節點佔用的記憶體，以及整棵樹的填充率；需走訪所有節點
+    MemoryUsage memoryUsage() const {
+        return computeMemory(shapeStats(), pool);
+    }
+
+    // 線上壓縮：先釋放 pool 中閒置節點的 keys / children 緩衝區，再由上而下、由左往右把同一個父節點下的子節點重新均分成
+    // 較少的節點，讓節點接近 fillFactor (與 bulkLoad 相同) 的填充率，根節點的子節點全部合併時樹高減一。
+    // 每次呼叫最多處理約 budget 個節點後返回，可在兩個請求之間分次執行 (搭配 compactionPending)；回傳這次從樹上釋放的節點數
+    size_t compact(size_t budget, double fillFactor = 1.0) {
+        budget -= pool.releaseIdle(budget, [](MWayNode* node) {
+            std::vector<int>().swap(node->keys);
+            std::vector<MWayNode*>().swap(node->children);
+        });
+        if (!root || budget == 0) return 0;
+        if (!compacting) compactCursor = INT32_MIN; // 新的一輪由最左邊開始
+        compacting = true;
+        size_t freed = 0;
+        bool progressed = false;
+        int target = targetKeyCount(fillFactor, minKeys(), m - 1);
+        if (!root->children[0] || compactSubtree(root, true, target, budget, freed, progressed)) {
+            compacting = false; // 這一輪完成
+        }
+        while (root->keys.empty() && root->children[0]) { // 根節點的子節點全部合併，樹高減一
+            MWayNode* tmp = root;
+            root = root->children[0];
+            pool.destroy(tmp);
+            freed++;
+        }
+        return freed;
+    }
+
+    // 是否還有 compact 可做的事：一輪尚未完成，或 pool 中還有沒釋放緩衝區的閒置節點
+    bool compactionPending() const {
+        return compacting || pool.hasUnreleasedIdle();
+    }
+
+    // 依序對 [lo, hi] 內的每個鍵值呼叫 fn，只走訪與區間重疊的子樹
+    template <typename Fn>
+    void forEachInRange(int lo, int hi, Fn fn) const {
+        if (root && lo <= hi) forEachInRange(root, lo, hi, fn);
+    }
+
+    // 中序走訪 node 子樹內落在 [lo, hi] 的鍵值；遇到大於 hi 的鍵值時回傳 false 表示可以停止
+    template <typename Fn>
+    static bool forEachInRange(const MWayNode* node, int lo, int hi, Fn& fn) {
+        bool leaf = !node->children[0];
+        int n = static_cast<int>(node->keys.size());
+        for (int i = nodesearch::rank(node->keys.data(), n, lo); i < n; i++) {
+            if (!leaf && !forEachInRange(node->children[i], lo, hi, fn)) return false;
+            if (node->keys[i] > hi) return false;
+            fn(node->keys[i]);
+        }
+        return leaf || forEachInRange(node->children[n], lo, hi, fn);
+    }
+
+    // 打印樹的結構：每個節點一行並依層次縮排，只走訪實際使用的子節點欄位，整棵樹寫入同一塊緩衝區後才輸出
+    void printTree() const {
+        render::printIndented(std::cout, root, [](const MWayNode* node) { return node->children[0] == nullptr; });
+    }
+
+    // 逐層輸出 (每層一行)，limits 限制輸出的層數、每層的節點數與每個節點的鍵值數，適合檢視很大的樹
+    void printLevels(std::ostream& out, const render::Limits& limits = {}) const {
+        render::printLevels(out, root, [](const MWayNode* node) { return node->children[0] == nullptr; }, limits);
+    }
+
+    // 匯出 Graphviz DOT (dot -Tsvg 可直接繪製)
+    void exportDot(std::ostream& out, const render::Limits& limits = {}) const {
+        render::writeDot(out, root, [](const MWayNode* node) { return node->children[0] == nullptr; }, limits);
+    }
+
+    // 匯出巢狀的 JSON
+    void exportJson(std::ostream& out, const render::Limits& limits = {}) const {
+        render::writeJson(out, root, [](const MWayNode* node) { return node->children[0] == nullptr; }, limits);
+    }
+};
@@ -0,0 +1,90 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// 分塊 Bloom filter (split block Bloom filter)：每個鍵值只對應一個 64 位元組的區塊 (一條快取線)，
+// 在區塊的 8 個 64 位元字中各設一個位元，因此 add / mayContain 都只碰一條快取線。
+// mayContain 為 false 時鍵值一定不存在；為 true 時可能是誤判 (每個鍵值 10 個位元時約 1%)。
+// 無法刪除鍵值：刪除後的鍵值仍會回答 true，由使用者在過時的鍵值太多時以 clear / reserve 重建
+class BlockedBloomFilter {
+    struct alignas(64) Block {
+        uint64_t words[8];
+    };
+
+    std::vector<Block> blocks;
+    size_t added = 0; // 重建後加入過的鍵值數 (含已刪除的)
+
+    // 每個字用不同的奇數乘上雜湊值，取最高 6 位元作為該字內的位元位置 (與 Parquet 的 SBBF 相同)
+    static constexpr uint32_t kSalt[8] = { 0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                           0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U };
+
+    static uint64_t hash(int key) {
+        uint64_t h = static_cast<uint32_t>(key); // fmix64 (MurmurHash3)
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // 高 32 位元選區塊 (乘法取代取餘數)，低 32 位元決定區塊內的位元
+    size_t blockIndex(uint64_t h) const {
+        return static_cast<size_t>(((h >> 32) * blocks.size()) >> 32);
+    }
+
+public:
+    BlockedBloomFilter() = default;
+
+    // 預計存放 expectedKeys 個鍵值，每個鍵值約 bitsPerKey 個位元
+    BlockedBloomFilter(size_t expectedKeys, double bitsPerKey) {
+        reserve(expectedKeys, bitsPerKey);
+    }
+
+    // 清空並依新的預計鍵值數重新配置
+    void reserve(size_t expectedKeys, double bitsPerKey) {
+        size_t bits = static_cast<size_t>(std::max<double>(1.0, static_cast<double>(expectedKeys) * bitsPerKey));
+        blocks.assign(std::max<size_t>(1, (bits + 511) / 512), Block{});
+        added = 0;
+    }
+
+    // 清除所有位元，保留目前的大小
+    void clear() {
+        std::fill(blocks.begin(), blocks.end(), Block{});
+        added = 0;
+    }
+
+    void add(int key) {
+        uint64_t h = hash(key);
+        Block& block = blocks[blockIndex(h)];
+        uint32_t low = static_cast<uint32_t>(h);
+        for (int i = 0; i < 8; i++) block.words[i] |= uint64_t{ 1 } << ((low * kSalt[i]) >> 26);
+        added++;
+    }
+
+    bool mayContain(int key) const {
+        if (blocks.empty()) return false;
+        uint64_t h = hash(key);
+        const Block& block = blocks[blockIndex(h)];
+        uint32_t low = static_cast<uint32_t>(h);
+        uint64_t missing = 0;
+        for (int i = 0; i < 8; i++) missing |= ~block.words[i] & (uint64_t{ 1 } << ((low * kSalt[i]) >> 26));
+        return missing == 0;
+    }
+
+    // 重建後加入過的鍵值數
+    size_t count() const {
+        return added;
+    }
+
+    // 依配置的位元數，維持約 bitsPerKey 個位元時可容納的鍵值數
+    size_t capacity(double bitsPerKey) const {
+        return static_cast<size_t>(static_cast<double>(blocks.size()) * 512 / bitsPerKey);
+    }
+
+    size_t memoryBytes() const {
+        return blocks.size() * sizeof(Block);
+    }
+};
@@ -0,0 +1,104 @@
+﻿#pragma once
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+// 節點配置器：以 slab 為單位一次配置多個節點，釋放的節點放入 free list 重複使用
+// 節點被回收時不會解構，保留其 keys / children 的容量，下次取用時只呼叫 Node::reset()
+// reset() 只把 bump 指標歸零，整棵樹的節點在 O(1) 內全部回收
+template <typename Node>
+class NodePool {
+    std::vector<Node*> slabs; // 每個 slab 的起始位址
+    size_t slabSize; // 每個 slab 的節點數
+    size_t constructed = 0; // 已經建構過的節點數，解構時只需處理這些節點
+    size_t used = 0; // bump 指標：[0, used) 的節點已被取用過
+    std::vector<Node*> freeList; // 已釋放、可重複使用的節點
+    size_t releasedFree = 0; // freeList 的前 releasedFree 個節點已交給過 releaseIdle
+    size_t releasedBump = 0; // [used, releasedBump) 的節點已交給過 releaseIdle
+
+    // 第 i 個節點的位址
+    Node* slot(size_t i) const {
+        return slabs[i / slabSize] + i % slabSize;
+    }
+
+public:
+    explicit NodePool(size_t slabSize = 256) : slabSize(slabSize) {}
+
+    ~NodePool() {
+        for (size_t i = 0; i < constructed; i++) slot(i)->~Node();
+        for (Node* slab : slabs) ::operator delete(slab);
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // 取得一個節點，優先使用 free list，其次是已建構過但被 reset() 回收的節點
+    template <typename... Args>
+    Node* create(Args&&... args) {
+        if (!freeList.empty()) {
+            Node* node = freeList.back();
+            freeList.pop_back();
+            releasedFree = std::min(releasedFree, freeList.size());
+            node->reset(std::forward<Args>(args)...);
+            return node;
+        }
+
+        if (used == slabs.size() * slabSize) { // 所有 slab 都用完，配置新的 slab
+            slabs.push_back(static_cast<Node*>(::operator new(sizeof(Node) * slabSize)));
+        }
+
+        Node* node = slot(used);
+        if (used < constructed) {
+            node->reset(std::forward<Args>(args)...);
+        }
+        else {
+            new (node) Node(std::forward<Args>(args)...);
+            constructed++;
+        }
+        used++;
+        return node;
+    }
+
+    // 歸還單一節點 (合併或根節點下移時使用)
+    void destroy(Node* node) {
+        freeList.push_back(node);
+    }
+
+    // 一次回收所有節點，slab 與節點內的緩衝區保留給之後重建使用
+    void reset() {
+        used = 0;
+        freeList.clear();
+        releasedFree = 0;
+        releasedBump = 0;
+    }
+
+    // 對每個閒置的節點 (free list 與 reset() 後尚未重新取用的節點) 呼叫 fn，例如計算佔用的記憶體
+    template <typename Fn>
+    void forEachIdle(Fn fn) const {
+        for (Node* node : freeList) fn(node);
+        for (size_t i = used; i < constructed; i++) fn(slot(i));
+    }
+
+    // 對最多 limit 個還沒處理過的閒置節點呼叫 release (例如釋放其 keys / children 緩衝區)，回傳處理的個數；
+    // 節點被重新取用之前不會再交給 release，因此可以分次呼叫
+    template <typename Fn>
+    size_t releaseIdle(size_t limit, Fn release) {
+        size_t done = 0;
+        for (; done < limit && releasedFree < freeList.size(); done++) release(freeList[releasedFree++]);
+        releasedBump = std::max(releasedBump, used);
+        for (; done < limit && releasedBump < constructed; done++) release(slot(releasedBump++));
+        return done;
+    }
+
+    // 是否還有沒交給 releaseIdle 處理過的閒置節點
+    bool hasUnreleasedIdle() const {
+        return releasedFree < freeList.size() || std::max(releasedBump, used) < constructed;
+    }
+
+    // 目前被樹使用中的節點數
+    size_t liveCount() const {
+        return used - freeList.size();
+    }
+};
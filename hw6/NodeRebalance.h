@@ -0,0 +1,94 @@
+﻿#pragma once
+
+// BTree 與 PagedBTree 共用的分裂、借用與合併 (CLRS 最小度數 t 的 B-tree)。
+// 節點的存取由 nodes 提供，同一套演算法可以作用在記憶體中的節點或緩衝池中的頁面：
+//   leaf(h) / count(h) / key(h, i) / setKey(h, i, k)：讀寫節點 h 的欄位
+//   ref(h) / childRef(h, i) / setChild(h, i, r)：節點的參照 (指標或頁碼) 與子節點欄位
+//   childCount(h, i)：第 i 個子節點的鍵值數，只讀不寫
+//   child(h, i)：取得第 i 個子節點的可寫入版本 (BTree 經過 own 做寫入時複製，PagedBTree 釘住頁面)
+//   create(leaf) / destroy(h)：配置與回收節點
+//   insertKey(h, i, k) / eraseKey(h, i)：插入或刪除位置 i 的鍵值
+//   insertChild(h, i, r) / eraseChild(h, i)：插入或刪除第 i 個子節點欄位，分別在 insertKey / eraseKey 之後呼叫
+//   truncate(h, n)：只保留前 n 個鍵值與前 n+1 個子節點
+//   appendKeys(dst, src, from)：把 src 第 from 個之後的鍵值接在 dst 最後，src 不變
+//   borrowFromPrev / borrowFromNext / merge(h, i)：fill 透過這三個呼叫執行，樹可在其中維護自己的統計
+namespace rebalance {
+
+    // 分裂 node 已滿的第 i 個子節點 y：右半部的 t-1 個鍵值與 t 個子節點移到新節點 z，中間鍵值提升到 node
+    template <typename Nodes, typename Node>
+    void splitChild(Nodes& nodes, Node& node, int i, int t) {
+        auto y = nodes.child(node, i);
+        auto z = nodes.create(nodes.leaf(y));
+        nodes.appendKeys(z, y, t);
+        if (!nodes.leaf(y)) {
+            for (int j = 0; j < t; j++) nodes.setChild(z, j, nodes.childRef(y, j + t));
+        }
+        int middle = nodes.key(y, t - 1);
+        nodes.truncate(y, t - 1);
+
+        nodes.insertKey(node, i, middle);
+        nodes.insertChild(node, i + 1, nodes.ref(z));
+    }
+
+    // 第 idx 個子節點從左兄弟借用一個鍵值：父節點的分隔鍵下移，左兄弟最大的鍵值上移
+    template <typename Nodes, typename Node>
+    void borrowFromPrev(Nodes& nodes, Node& node, int idx) {
+        auto child = nodes.child(node, idx);
+        auto sibling = nodes.child(node, idx - 1);
+        int last = nodes.count(sibling) - 1;
+
+        nodes.insertKey(child, 0, nodes.key(node, idx - 1));
+        if (!nodes.leaf(child)) nodes.insertChild(child, 0, nodes.childRef(sibling, last + 1));
+        nodes.setKey(node, idx - 1, nodes.key(sibling, last));
+        nodes.truncate(sibling, last);
+    }
+
+    // 第 idx 個子節點從右兄弟借用一個鍵值：父節點的分隔鍵下移，右兄弟最小的鍵值上移
+    template <typename Nodes, typename Node>
+    void borrowFromNext(Nodes& nodes, Node& node, int idx) {
+        auto child = nodes.child(node, idx);
+        auto sibling = nodes.child(node, idx + 1);
+
+        nodes.insertKey(child, nodes.count(child), nodes.key(node, idx));
+        if (!nodes.leaf(child)) nodes.setChild(child, nodes.count(child), nodes.childRef(sibling, 0));
+        nodes.setKey(node, idx, nodes.key(sibling, 0));
+        nodes.eraseKey(sibling, 0);
+        if (!nodes.leaf(sibling)) nodes.eraseChild(sibling, 0);
+    }
+
+    // 把第 idx+1 個子節點與兩者之間的分隔鍵併入第 idx 個子節點，並回收右邊的節點
+    template <typename Nodes, typename Node>
+    void merge(Nodes& nodes, Node& node, int idx) {
+        auto child = nodes.child(node, idx);
+        auto sibling = nodes.child(node, idx + 1);
+
+        nodes.insertKey(child, nodes.count(child), nodes.key(node, idx));
+        int offset = nodes.count(child); // 右兄弟的子節點接在此位置之後
+        nodes.appendKeys(child, sibling, 0);
+        if (!nodes.leaf(child)) {
+            for (int i = 0; i <= nodes.count(sibling); i++) nodes.setChild(child, offset + i, nodes.childRef(sibling, i));
+        }
+
+        nodes.eraseKey(node, idx);
+        nodes.eraseChild(node, idx + 1);
+        nodes.destroy(sibling);
+    }
+
+    // 刪除時讓第 idx 個子節點至少有 t 個鍵值：優先向左、右兄弟借用，都不夠時與兄弟合併
+    template <typename Nodes, typename Node>
+    void fill(Nodes& nodes, Node& node, int idx, int t) {
+        int n = nodes.count(node);
+        if (idx != 0 && nodes.childCount(node, idx - 1) >= t) {
+            nodes.borrowFromPrev(node, idx);
+        }
+        else if (idx != n && nodes.childCount(node, idx + 1) >= t) {
+            nodes.borrowFromNext(node, idx);
+        }
+        else if (idx != n) {
+            nodes.merge(node, idx);
+        }
+        else {
+            nodes.merge(node, idx - 1);
+        }
+    }
+}
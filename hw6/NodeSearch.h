@@ -0,0 +1,118 @@
+﻿#pragma once
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HW6_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang 需要以 target 屬性才能在未加 -mavx2 的情況下使用 AVX2 指令，MSVC 則不需要
+#if defined(HW6_X86) && (defined(__GNUC__) || defined(__clang__))
+#define HW6_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define HW6_TARGET_SSE __attribute__((target("sse2")))
+#else
+#define HW6_TARGET_AVX2
+#define HW6_TARGET_SSE
+#endif
+
+// 節點內搜尋：回傳 keys[0..n) 中小於 key 的個數 (即 key 在節點中的位置)
+// 依 CPU 在執行期選擇 AVX2、SSE2 或純量版本
+namespace nodesearch {
+
+    // 節點較寬時先以二分搜尋縮小到此寬度，再以向量比較計數
+    constexpr int kWindow = 64;
+
+    inline int countLessScalar(const int* keys, int n, int key) {
+        int count = 0;
+        for (int i = 0; i < n; i++) count += keys[i] < key; // 無分支累加
+        return count;
+    }
+
+#ifdef HW6_X86
+    inline int popcount(unsigned mask) {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt(mask));
+#else
+        return __builtin_popcount(mask);
+#endif
+    }
+
+    constexpr unsigned char kBitCount4[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+    HW6_TARGET_SSE inline int countLessSse(const int* keys, int n, int key) {
+        __m128i needle = _mm_set1_epi32(key);
+        int count = 0, i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+            count += kBitCount4[_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, needle)))]; // 4 位元遮罩查表，不依賴 POPCNT
+        }
+        return count + countLessScalar(keys + i, n - i, key);
+    }
+
+    HW6_TARGET_AVX2 inline int countLessAvx2(const int* keys, int n, int key) {
+        __m256i needle = _mm256_set1_epi32(key);
+        int count = 0, i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+            count += popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, block)))));
+        }
+        return count + countLessScalar(keys + i, n - i, key);
+    }
+
+    inline bool cpuHasAvx2() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        return avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6; // 作業系統需保存 YMM 暫存器
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    using CountLessFn = int (*)(const int*, int, int);
+
+    // 第一次呼叫時偵測 CPU，之後皆透過同一個函式指標
+    inline CountLessFn selectCountLess() {
+#ifdef HW6_X86
+        static const CountLessFn fn = cpuHasAvx2() ? countLessAvx2 : countLessSse;
+        return fn;
+#else
+        return countLessScalar;
+#endif
+    }
+
+    // 回傳已排序陣列 keys[0..n) 中第一個不小於 key 的位置
+    inline int rank(const int* keys, int n, int key) {
+        int base = 0;
+        while (n > kWindow) { // 寬節點先以二分搜尋縮小範圍
+            int half = n / 2;
+            if (keys[base + half - 1] < key) base += half;
+            n -= half;
+        }
+        return base + selectCountLess()(keys + base, n, key);
+    }
+
+    // 節點容量在編譯期已知時的版本 (StaticTree 使用)：以固定的 Capacity 次比較掃描整個鍵值陣列，
+    // 位置 n 之後的欄位以遮罩排除，迴圈沒有依 n 而變的邊界，也不經過函式指標，編譯器可完全展開並向量化。
+    // 容量超過 kWindow 時固定掃描的成本高於二分搜尋，改用 rank
+    template <int Capacity>
+    inline int rankFixed(const int* keys, int n, int key) {
+        if constexpr (Capacity > kWindow) {
+            return rank(keys, n, key);
+        }
+        else {
+            int count = 0;
+            for (int i = 0; i < Capacity; i++) count += (i < n) & (keys[i] < key);
+            return count;
+        }
+    }
+}
@@ -0,0 +1,611 @@
+﻿#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include "NodeSearch.h"
+#include "NodeRebalance.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 存放在磁碟上的 B-tree：每個節點是檔案中固定大小的一頁，子節點以頁碼連結，
+// 讀寫經過容量固定的緩衝池 (CLOCK 置換)；也可用 mmap 以唯讀方式直接映射整個檔案
+// 分裂、借用與合併與 BTree 共用 NodeRebalance.h，頁面經由 PageAccess 釘住並標記 dirty；
+// 由根往下的插入與刪除以迴圈實作，每層只釘住目前節點與其子節點
+namespace paged {
+
+    using PageId = uint32_t;
+    constexpr PageId kNoPage = 0; // 第 0 頁是檔頭，不會是節點
+    constexpr uint32_t kMagic = 0x48573650; // "HW6P"
+
+    // 第 0 頁的內容
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t pageSize;
+        uint32_t t; // 最小度數
+        PageId root;
+        PageId pageCount; // 檔案中的總頁數 (含檔頭)
+        PageId freeHead; // 已釋放頁面串成的鏈結
+        uint64_t keyCount;
+    };
+
+    // 每個節點頁面的開頭，之後依序是 2t-1 個鍵值與 2t 個子節點頁碼
+    struct NodeHeader {
+        uint16_t leaf;
+        uint16_t count;
+        PageId nextFree; // 頁面被釋放時指向下一個空頁
+    };
+
+    // 一頁最多能放的最小度數：header + (2t-1) 個鍵值 + 2t 個頁碼
+    inline int maxDegreeFor(size_t pageSize) {
+        return static_cast<int>((pageSize - sizeof(NodeHeader) + sizeof(int32_t)) / (2 * (sizeof(int32_t) + sizeof(PageId))));
+    }
+
+    // 檢查頁面大小，在開啟檔案之前呼叫，避免不合法的參數仍建立或清空頁面檔
+    inline size_t checkPageSize(size_t pageSize) {
+        if (pageSize < 256) throw std::invalid_argument("頁面太小");
+        return pageSize;
+    }
+
+    // 以固定頁面大小讀寫檔案；唯讀模式下把整個檔案映射到記憶體
+    class PageFile {
+        std::fstream stream;
+        size_t pageSize;
+        bool mapped = false;
+        const uint8_t* base = nullptr;
+        size_t mappedBytes = 0;
+#ifdef _WIN32
+        HANDLE fileHandle = INVALID_HANDLE_VALUE;
+        HANDLE mappingHandle = nullptr;
+#endif
+
+    public:
+        PageFile(const std::string& path, size_t pageSize, bool readOnlyMmap) : pageSize(pageSize), mapped(readOnlyMmap) {
+            if (!mapped) {
+                stream.open(path, std::ios::in | std::ios::out | std::ios::binary);
+                if (!stream.is_open()) { // 檔案不存在時建立新檔
+                    stream.clear();
+                    stream.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+                }
+                if (!stream.is_open()) throw std::runtime_error("無法開啟頁面檔: " + path);
+                return;
+            }
+#ifdef _WIN32
+            fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (fileHandle == INVALID_HANDLE_VALUE) throw std::runtime_error("無法開啟頁面檔: " + path);
+            LARGE_INTEGER size;
+            GetFileSizeEx(fileHandle, &size);
+            mappedBytes = static_cast<size_t>(size.QuadPart);
+            mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mappingHandle) throw std::runtime_error("無法映射頁面檔: " + path);
+            base = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("無法開啟頁面檔: " + path);
+            struct stat info;
+            fstat(fd, &info);
+            mappedBytes = static_cast<size_t>(info.st_size);
+            void* addr = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd); // 映射建立後即可關閉檔案描述子
+            base = addr == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(addr);
+#endif
+            if (!base) throw std::runtime_error("無法映射頁面檔: " + path);
+        }
+
+        ~PageFile() {
+            if (!mapped) return;
+#ifdef _WIN32
+            if (base) UnmapViewOfFile(base);
+            if (mappingHandle) CloseHandle(mappingHandle);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+            if (base) munmap(const_cast<uint8_t*>(base), mappedBytes);
+#endif
+        }
+
+        PageFile(const PageFile&) = delete;
+        PageFile& operator=(const PageFile&) = delete;
+
+        bool isMapped() const { return mapped; }
+
+        // 檔案目前的頁數 (新建的檔案為 0)
+        PageId pageCountOnDisk() {
+            if (mapped) return static_cast<PageId>(mappedBytes / pageSize);
+            stream.seekg(0, std::ios::end);
+            return static_cast<PageId>(static_cast<uint64_t>(stream.tellg()) / pageSize);
+        }
+
+        // 唯讀映射模式下直接取得頁面位址
+        const uint8_t* mappedPage(PageId id) const {
+            return base + static_cast<size_t>(id) * pageSize;
+        }
+
+        void read(PageId id, uint8_t* buffer) {
+            stream.seekg(static_cast<std::streamoff>(id) * pageSize);
+            stream.read(reinterpret_cast<char*>(buffer), pageSize);
+            if (!stream) { // 超出檔尾的頁面視為全零
+                stream.clear();
+                std::memset(buffer, 0, pageSize);
+            }
+        }
+
+        void write(PageId id, const uint8_t* buffer) {
+            stream.seekp(static_cast<std::streamoff>(id) * pageSize);
+            stream.write(reinterpret_cast<const char*>(buffer), pageSize);
+        }
+
+        void sync() {
+            if (!mapped) stream.flush();
+        }
+    };
+
+    // 容量固定的緩衝池，以 CLOCK 演算法挑選未被釘住的頁框換出，髒頁換出時寫回檔案
+    class BufferPool {
+        struct Frame {
+            PageId id = kNoPage;
+            int pins = 0;
+            bool dirty = false;
+            bool referenced = false;
+        };
+
+        PageFile& file;
+        size_t pageSize;
+        std::vector<uint8_t> memory;
+        std::vector<Frame> frames;
+        std::unordered_map<PageId, size_t> table; // 頁碼 → 頁框
+        size_t hand = 0; // CLOCK 指針
+
+        uint8_t* frameData(size_t frame) { return memory.data() + frame * pageSize; }
+
+        // 找一個可以使用的頁框，必要時換出
+        size_t victim() {
+            for (size_t scanned = 0; scanned < 2 * frames.size() + 1; scanned++) {
+                Frame& frame = frames[hand];
+                size_t current = hand;
+                hand = (hand + 1) % frames.size();
+                if (frame.pins > 0) continue;
+                if (frame.referenced) { // 給第二次機會
+                    frame.referenced = false;
+                    continue;
+                }
+                if (frame.id != kNoPage) {
+                    if (frame.dirty) file.write(frame.id, frameData(current));
+                    table.erase(frame.id);
+                }
+                frame = Frame();
+                return current;
+            }
+            throw std::runtime_error("緩衝池的頁框全部被釘住");
+        }
+
+    public:
+        size_t hits = 0, misses = 0;
+
+        BufferPool(PageFile& file, size_t pageSize, size_t capacity)
+            : file(file), pageSize(pageSize), memory(pageSize * capacity), frames(capacity) {}
+
+        // 釘住頁面並回傳其內容；fresh 為 true 時表示新配置的頁面，不需從檔案讀取
+        uint8_t* pin(PageId id, bool fresh = false) {
+            auto it = table.find(id);
+            if (it != table.end()) {
+                hits++;
+                Frame& frame = frames[it->second];
+                frame.pins++;
+                frame.referenced = true;
+                return frameData(it->second);
+            }
+            misses++;
+            size_t slot = victim();
+            if (fresh) std::memset(frameData(slot), 0, pageSize);
+            else file.read(id, frameData(slot));
+            frames[slot].id = id;
+            frames[slot].pins = 1;
+            frames[slot].referenced = true;
+            table[id] = slot;
+            return frameData(slot);
+        }
+
+        void unpin(PageId id, bool dirty) {
+            Frame& frame = frames[table.at(id)];
+            frame.pins--;
+            frame.dirty = frame.dirty || dirty;
+        }
+
+        // 將所有髒頁寫回檔案
+        void flush() {
+            for (size_t i = 0; i < frames.size(); i++) {
+                if (frames[i].id != kNoPage && frames[i].dirty) {
+                    file.write(frames[i].id, frameData(i));
+                    frames[i].dirty = false;
+                }
+            }
+            file.sync();
+        }
+    };
+}
+
+// 以頁面為節點的 B-tree，插入與刪除的流程與 BTree 相同 (splitChild / fill / borrow / merge)，
+// 只是節點換成緩衝池中的頁面，修改過的頁面在換出或 flush 時寫回檔案
+class PagedBTree {
+public:
+    enum class Mode { ReadWrite, ReadOnlyMmap };
+
+private:
+    // 釘住一個頁面的 RAII 物件，提供節點欄位的存取
+    class Page {
+        PagedBTree* tree;
+        paged::PageId pageId;
+        uint8_t* data;
+        bool dirty = false;
+
+        paged::NodeHeader* header() const { return reinterpret_cast<paged::NodeHeader*>(data); }
+        int32_t* keyArray() const { return reinterpret_cast<int32_t*>(data + sizeof(paged::NodeHeader)); }
+        paged::PageId* childArray() const { return reinterpret_cast<paged::PageId*>(data + sizeof(paged::NodeHeader) + sizeof(int32_t) * (2 * tree->t - 1)); }
+
+    public:
+        Page(PagedBTree* tree, paged::PageId pageId, bool fresh = false) : tree(tree), pageId(pageId) {
+            data = tree->pool ? tree->pool->pin(pageId, fresh) : const_cast<uint8_t*>(tree->file.mappedPage(pageId));
+        }
+        ~Page() {
+            if (tree->pool) tree->pool->unpin(pageId, dirty);
+        }
+        Page(const Page&) = delete;
+        Page& operator=(const Page&) = delete;
+
+        paged::PageId id() const { return pageId; }
+        bool leaf() const { return header()->leaf != 0; }
+        int count() const { return header()->count; }
+        int key(int i) const { return keyArray()[i]; }
+        paged::PageId child(int i) const { return childArray()[i]; }
+        const int32_t* keys() const { return keyArray(); }
+
+        // 以下修改會把頁面標記為髒頁
+        void setLeaf(bool leaf) { header()->leaf = leaf; dirty = true; }
+        void setCount(int count) { header()->count = static_cast<uint16_t>(count); dirty = true; }
+        void setKey(int i, int key) { keyArray()[i] = key; dirty = true; }
+        void setChild(int i, paged::PageId child) { childArray()[i] = child; dirty = true; }
+        void setNextFree(paged::PageId next) { header()->nextFree = next; dirty = true; }
+        paged::PageId nextFree() const { return header()->nextFree; }
+
+        // 在位置 i 插入鍵值 (及其右邊的子節點)
+        void insertKey(int i, int key) {
+            std::memmove(keyArray() + i + 1, keyArray() + i, sizeof(int32_t) * (count() - i));
+            keyArray()[i] = key;
+            setCount(count() + 1);
+        }
+        void insertChild(int i, paged::PageId child) { // 需在 insertKey 之後呼叫，count 已加一
+            std::memmove(childArray() + i + 1, childArray() + i, sizeof(paged::PageId) * (count() - i));
+            childArray()[i] = child;
+            dirty = true;
+        }
+        void eraseKey(int i) {
+            std::memmove(keyArray() + i, keyArray() + i + 1, sizeof(int32_t) * (count() - i - 1));
+            setCount(count() - 1);
+        }
+        void eraseChild(int i) { // 需在 eraseKey 之後呼叫，count 已減一
+            std::memmove(childArray() + i, childArray() + i + 1, sizeof(paged::PageId) * (count() + 1 - i));
+            dirty = true;
+        }
+    };
+
+    paged::PageFile file;
+    std::unique_ptr<paged::BufferPool> pool; // 唯讀映射模式下為 nullptr
+    paged::FileHeader header;
+    size_t pageSize;
+    int t; // 最小度數，由頁面大小決定
+
+    // 配置一個空頁面，優先使用已釋放的頁面
+    paged::PageId allocatePage(bool leaf) {
+        paged::PageId id;
+        if (header.freeHead != paged::kNoPage) {
+            id = header.freeHead;
+            Page page(this, id);
+            header.freeHead = page.nextFree();
+        }
+        else {
+            id = header.pageCount++;
+        }
+        Page page(this, id, true);
+        page.setLeaf(leaf);
+        page.setCount(0);
+        page.setNextFree(paged::kNoPage);
+        return id;
+    }
+
+    // 釋放頁面，加入空頁鏈結
+    void freePage(paged::PageId id) {
+        Page page(this, id);
+        page.setCount(0);
+        page.setNextFree(header.freeHead);
+        header.freeHead = id;
+    }
+
+    void requireWritable() const {
+        if (!pool) throw std::logic_error("PagedBTree 以唯讀映射模式開啟，不能修改");
+    }
+
+    // 提供 rebalance:: 演算法存取頁面的介面，與 BTree::NodeAccess 對應；子節點以頁碼表示，取得子節點即釘住該頁
+    struct PageAccess {
+        PagedBTree& tree;
+
+        static bool leaf(const Page& page) { return page.leaf(); }
+        static int count(const Page& page) { return page.count(); }
+        static int key(const Page& page, int i) { return page.key(i); }
+        static void setKey(Page& page, int i, int k) { page.setKey(i, k); }
+        static paged::PageId ref(const Page& page) { return page.id(); }
+        static paged::PageId childRef(const Page& page, int i) { return page.child(i); }
+        static void setChild(Page& page, int i, paged::PageId child) { page.setChild(i, child); }
+        int childCount(const Page& page, int i) { Page child(&tree, page.child(i)); return child.count(); }
+
+        Page child(const Page& page, int i) { return Page(&tree, page.child(i)); }
+        Page create(bool leaf) { return Page(&tree, tree.allocatePage(leaf)); }
+        void destroy(Page& page) { tree.freePage(page.id()); }
+
+        static void insertKey(Page& page, int i, int k) { page.insertKey(i, k); }
+        static void eraseKey(Page& page, int i) { page.eraseKey(i); }
+        static void insertChild(Page& page, int i, paged::PageId child) { page.insertChild(i, child); }
+        static void eraseChild(Page& page, int i) { page.eraseChild(i); }
+        static void truncate(Page& page, int n) { page.setCount(n); }
+        static void appendKeys(Page& dst, const Page& src, int from) {
+            int n = dst.count();
+            for (int j = from; j < src.count(); j++) dst.setKey(n + j - from, src.key(j));
+            dst.setCount(n + src.count() - from);
+        }
+
+        void borrowFromPrev(Page& node, int idx) { rebalance::borrowFromPrev(*this, node, idx); }
+        void borrowFromNext(Page& node, int idx) { rebalance::borrowFromNext(*this, node, idx); }
+        void merge(Page& node, int idx) { rebalance::merge(*this, node, idx); }
+    };
+
+    // 分裂子節點 (與 BTree 共用 rebalance::splitChild)
+    void splitChild(Page& node, int i) {
+        PageAccess pages{ *this };
+        rebalance::splitChild(pages, node, i, t);
+    }
+
+    // 插入鍵值到非滿節點 (同 BTree::insertNonFull，以迴圈代替遞迴)
+    void insertNonFull(paged::PageId id, int k) {
+        while (true) {
+            Page node(this, id);
+            int i = node.count() - 1;
+            if (node.leaf()) {
+                while (i >= 0 && k < node.key(i)) i--;
+                node.insertKey(i + 1, k);
+                return;
+            }
+            while (i >= 0 && k < node.key(i)) i--;
+            i++;
+            bool full;
+            {
+                Page child(this, node.child(i));
+                full = child.count() == 2 * t - 1;
+            }
+            if (full) {
+                splitChild(node, i);
+                if (k > node.key(i)) i++;
+            }
+            id = node.child(i);
+        }
+    }
+
+    // 合併節點
+    void merge(Page& node, int idx) {
+        PageAccess pages{ *this };
+        rebalance::merge(pages, node, idx);
+    }
+
+    // 處理子節點數量不足的情況 (與 BTree 共用 rebalance::fill 及其借用與合併)
+    void fill(Page& node, int idx) {
+        PageAccess pages{ *this };
+        rebalance::fill(pages, node, idx, t);
+    }
+
+    // 獲取鍵值的前驅
+    int getPredecessor(paged::PageId id) {
+        while (true) {
+            Page cur(this, id);
+            if (cur.leaf()) return cur.key(cur.count() - 1);
+            id = cur.child(cur.count());
+        }
+    }
+
+    // 獲取鍵值的後繼
+    int getSuccessor(paged::PageId id) {
+        while (true) {
+            Page cur(this, id);
+            if (cur.leaf()) return cur.key(0);
+            id = cur.child(0);
+        }
+    }
+
+    // 從節點中刪除鍵值 (同 BTree::remove)；以迴圈往下走，每層只釘住目前節點與其子節點
+    bool remove(paged::PageId id, int k) {
+        while (true) {
+            Page node(this, id);
+            int n = node.count();
+            int idx = nodesearch::rank(node.keys(), n, k);
+            auto childCount = [&](int i) { Page page(this, node.child(i)); return page.count(); };
+
+            if (idx < n && node.key(idx) == k) {
+                if (node.leaf()) {
+                    node.eraseKey(idx);
+                    return true;
+                }
+                if (childCount(idx) >= t) {
+                    k = getPredecessor(node.child(idx));
+                    node.setKey(idx, k);
+                    id = node.child(idx);
+                }
+                else if (childCount(idx + 1) >= t) {
+                    k = getSuccessor(node.child(idx + 1));
+                    node.setKey(idx, k);
+                    id = node.child(idx + 1);
+                }
+                else {
+                    merge(node, idx);
+                    id = node.child(idx);
+                }
+                continue;
+            }
+
+            if (node.leaf()) return false;
+            bool flag = (idx == n);
+            if (childCount(idx) < t) fill(node, idx);
+            id = (flag && idx > node.count()) ? node.child(idx - 1) : node.child(idx);
+        }
+    }
+
+    // 遞迴地打印樹的結構
+    void printTree(paged::PageId id, int level) {
+        Page node(this, id);
+        std::cout << std::string(level * 4, ' ');
+        for (int i = 0; i < node.count(); i++) std::cout << node.key(i) << " ";
+        std::cout << "\n";
+        if (!node.leaf()) {
+            for (int i = 0; i <= node.count(); i++) printTree(node.child(i), level + 1);
+        }
+    }
+
+public:
+    // 開啟 (或建立) 頁面檔；t 為 0 時使用該頁面大小能容納的最大度數
+    PagedBTree(const std::string& path, size_t pageSize = 4096, size_t poolPages = 256, Mode mode = Mode::ReadWrite, int t = 0)
+        : file(path, paged::checkPageSize(pageSize), mode == Mode::ReadOnlyMmap), pool(nullptr), header(), pageSize(pageSize), t(0) {
+        if (!file.isMapped()) pool = std::make_unique<paged::BufferPool>(file, pageSize, std::max<size_t>(poolPages, 8));
+
+        if (file.pageCountOnDisk() > 0) { // 既有檔案：讀取檔頭
+            std::vector<uint8_t> first(pageSize);
+            if (file.isMapped()) std::memcpy(first.data(), file.mappedPage(0), pageSize);
+            else file.read(0, first.data());
+            std::memcpy(&header, first.data(), sizeof(header));
+            if (header.magic != paged::kMagic || header.pageSize != pageSize) throw std::runtime_error("頁面檔格式不符");
+            // 度數超過頁面容量時節點會寫出頁面之外；頁碼超過總頁數 (映射模式下為檔案實際頁數) 時會讀到檔案之外
+            if (header.t < 2 || header.t > static_cast<uint32_t>(paged::maxDegreeFor(pageSize)) || header.pageCount == 0
+                || header.root >= header.pageCount || header.freeHead >= header.pageCount
+                || (file.isMapped() && header.pageCount > file.pageCountOnDisk())) throw std::runtime_error("頁面檔格式不符");
+        }
+        else {
+            if (file.isMapped()) throw std::runtime_error("唯讀模式需要既有的頁面檔");
+            int maxT = paged::maxDegreeFor(pageSize);
+            header.magic = paged::kMagic;
+            header.pageSize = static_cast<uint32_t>(pageSize);
+            header.t = static_cast<uint32_t>(t > 1 ? std::min(t, maxT) : maxT);
+            header.root = paged::kNoPage;
+            header.pageCount = 1;
+            header.freeHead = paged::kNoPage;
+            header.keyCount = 0;
+        }
+        this->t = static_cast<int>(header.t);
+    }
+
+    ~PagedBTree() {
+        if (pool) flush();
+    }
+
+    PagedBTree(const PagedBTree&) = delete;
+    PagedBTree& operator=(const PagedBTree&) = delete;
+
+    // 將髒頁與檔頭寫回檔案
+    void flush() {
+        requireWritable();
+        pool->flush();
+        std::vector<uint8_t> first(pageSize, 0);
+        std::memcpy(first.data(), &header, sizeof(header));
+        file.write(0, first.data());
+        file.sync();
+    }
+
+    // 插入鍵值
+    void insert(int k) {
+        requireWritable();
+        header.keyCount++;
+        if (header.root == paged::kNoPage) {
+            header.root = allocatePage(true);
+            Page root(this, header.root);
+            root.insertKey(0, k);
+            return;
+        }
+
+        bool full;
+        {
+            Page root(this, header.root);
+            full = root.count() == 2 * t - 1;
+        }
+        if (full) { // 根節點已滿時先分裂
+            paged::PageId newRootId = allocatePage(false);
+            Page newRoot(this, newRootId);
+            newRoot.setChild(0, header.root);
+            splitChild(newRoot, 0);
+            header.root = newRootId;
+        }
+        insertNonFull(header.root, k);
+    }
+
+    // 刪除鍵值；先以唯讀的搜尋確認鍵值存在，不存在的鍵值不會合併或借用頁面，也不會弄髒任何頁面
+    void remove(int k) {
+        requireWritable();
+        if (header.root == paged::kNoPage) return;
+        if (!contains(k)) {
+            std::cout << "Key " << k << " not found in the tree.\n";
+            return;
+        }
+
+        if (remove(header.root, k)) header.keyCount--;
+
+        paged::PageId oldRoot = header.root;
+        bool emptyRoot, leafRoot;
+        paged::PageId firstChild;
+        {
+            Page root(this, oldRoot);
+            emptyRoot = root.count() == 0;
+            leafRoot = root.leaf();
+            firstChild = root.child(0);
+        }
+        if (emptyRoot) { // 根節點已空，樹高減一
+            header.root = leafRoot ? paged::kNoPage : firstChild;
+            freePage(oldRoot);
+        }
+    }
+
+    // 判斷鍵值是否存在
+    bool contains(int k) {
+        paged::PageId id = header.root;
+        while (id != paged::kNoPage) {
+            Page node(this, id);
+            int n = node.count();
+            int i = nodesearch::rank(node.keys(), n, k);
+            if (i < n && node.key(i) == k) return true;
+            if (node.leaf()) return false;
+            id = node.child(i);
+        }
+        return false;
+    }
+
+    // 打印整棵樹
+    void printTree() {
+        if (header.root != paged::kNoPage) printTree(header.root, 0);
+    }
+
+    uint64_t size() const { return header.keyCount; }
+    int degree() const { return t; }
+    paged::PageId pageCount() const { return header.pageCount; }
+
+    // 緩衝池命中與未命中次數 (唯讀映射模式皆為 0)
+    size_t poolHits() const { return pool ? pool->hits : 0; }
+    size_t poolMisses() const { return pool ? pool->misses : 0; }
+};
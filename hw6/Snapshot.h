@@ -0,0 +1,142 @@
+﻿#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// BTree / MWayTree 共用的二進位快照格式：
+// 檔頭之後依層序 (level order) 存放每個節點，每個節點為一個 uint32 (鍵值數 << 1 | 是否為葉節點) 加上鍵值陣列，
+// 內部節點的 keys+1 個子節點依序出現在後面，因此載入時只要一個游標就能接回所有子節點指標
+namespace snapshot {
+
+    constexpr uint32_t kMagic = 0x53365748; // "HW6S"
+    constexpr uint32_t kVersion = 2; // 2: 根以外的節點保證不少於下限 (遞增插入模式在存檔前結束)
+    constexpr uint32_t kMaxDegree = 65536; // 載入時接受的最大 m 或 t，避免損毀的檔頭要求配置巨大的節點
+
+    enum class Kind : uint32_t { MWay = 1, BTree = 2 };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t kind;
+        uint32_t degree; // MWayTree 的 m 或 BTree 的 t
+        uint64_t nodeCount;
+        uint64_t keyCount;
+    };
+
+    template <typename T>
+    void append(std::vector<char>& out, const T* data, size_t count) {
+        const char* bytes = reinterpret_cast<const char*>(data);
+        out.insert(out.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    // 以層序寫出整棵樹；先在記憶體中組好整個檔案，再一次寫入
+    template <typename Node, typename IsLeaf>
+    bool save(const std::string& path, Kind kind, int degree, const Node* root, IsLeaf isLeaf) {
+        std::vector<const Node*> order;
+        if (root) order.push_back(root);
+        uint64_t keyCount = 0;
+        for (size_t i = 0; i < order.size(); i++) { // order 本身就是 BFS 佇列
+            const Node* node = order[i];
+            keyCount += node->keys.size();
+            if (!isLeaf(node)) {
+                for (size_t j = 0; j <= node->keys.size(); j++) order.push_back(node->children[j]);
+            }
+        }
+
+        Header header = { kMagic, kVersion, static_cast<uint32_t>(kind), static_cast<uint32_t>(degree), order.size(), keyCount };
+        std::vector<char> out;
+        out.reserve(sizeof(Header) + order.size() * sizeof(uint32_t) + keyCount * sizeof(int32_t));
+        append(out, &header, 1);
+        for (const Node* node : order) {
+            uint32_t tag = static_cast<uint32_t>(node->keys.size()) << 1 | (isLeaf(node) ? 1u : 0u);
+            append(out, &tag, 1);
+            append(out, node->keys.data(), node->keys.size());
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        return static_cast<bool>(file);
+    }
+
+    // 一次讀入整個檔案
+    inline bool readFile(const std::string& path, std::vector<char>& data) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        return static_cast<bool>(file);
+    }
+
+    // 讀出檔頭並檢查格式與樹的種類
+    inline bool readHeader(const std::vector<char>& data, Kind kind, Header& header) {
+        if (data.size() < sizeof(Header)) return false;
+        std::memcpy(&header, data.data(), sizeof(Header));
+        return header.magic == kMagic && header.version == kVersion && header.kind == static_cast<uint32_t>(kind);
+    }
+
+    // 依層序重建節點並接回子節點指標，不經過任何插入或分裂；格式錯誤或結構不是合法的 B-tree 時回傳 false
+    // create(leaf) 建立一個空節點，minKeys / maxKeys 為根以外的節點鍵值個數的下限與上限
+    template <typename Node, typename Create>
+    bool load(const std::vector<char>& data, const Header& header, int minKeys, int maxKeys, Create create, Node*& root) {
+        root = nullptr;
+        if (header.nodeCount == 0) return true;
+        size_t payload = data.size() - sizeof(Header);
+        if (header.nodeCount > payload / sizeof(uint32_t)) return false; // 每個節點至少有 4 位元組的標記，檔案不可能容納這麼多節點
+        // 根以外的節點至少有 minKeys 個鍵值；度數大到連這些節點都放不進檔案時直接拒絕
+        if (header.nodeCount - 1 > payload / (sizeof(uint32_t) + static_cast<size_t>(minKeys) * sizeof(int32_t))) return false;
+
+        std::vector<Node*> nodes;
+        std::vector<bool> leaves;
+        nodes.reserve(header.nodeCount);
+        leaves.reserve(header.nodeCount);
+        size_t pos = sizeof(Header);
+        for (uint64_t i = 0; i < header.nodeCount; i++) {
+            uint32_t tag;
+            if (data.size() - pos < sizeof(tag)) return false;
+            std::memcpy(&tag, data.data() + pos, sizeof(tag));
+            pos += sizeof(tag);
+
+            size_t count = tag >> 1;
+            bool leaf = tag & 1u;
+            if (count > static_cast<size_t>(maxKeys) || (data.size() - pos) / sizeof(int32_t) < count) return false;
+            if (i > 0 && count < static_cast<size_t>(minKeys)) return false; // 節點不足半滿，不是合法的 B-tree
+            Node* node = create(leaf);
+            node->keys.resize(count);
+            std::memcpy(node->keys.data(), data.data() + pos, count * sizeof(int32_t));
+            pos += count * sizeof(int32_t);
+            nodes.push_back(node);
+            leaves.push_back(leaf);
+        }
+
+        // 接回子節點時順便檢查結構：所有葉節點同深度，每個節點的鍵值有序且落在父節點的兩個分隔鍵之間
+        std::vector<size_t> depth(nodes.size(), 0);
+        std::vector<int64_t> low(nodes.size(), INT32_MIN), high(nodes.size(), INT32_MAX);
+        size_t leafDepth = SIZE_MAX;
+        size_t next = 1; // 下一個尚未接上的子節點
+        for (size_t i = 0; i < nodes.size(); i++) {
+            const std::vector<int>& keys = nodes[i]->keys;
+            if (!std::is_sorted(keys.begin(), keys.end())) return false;
+            if (!keys.empty() && (keys.front() < low[i] || keys.back() > high[i])) return false;
+            if (leaves[i]) {
+                if (leafDepth == SIZE_MAX) leafDepth = depth[i];
+                else if (depth[i] != leafDepth) return false;
+                continue;
+            }
+            for (size_t j = 0; j <= keys.size(); j++) {
+                if (next >= nodes.size()) return false;
+                nodes[i]->children[j] = nodes[next];
+                depth[next] = depth[i] + 1;
+                low[next] = j > 0 ? keys[j - 1] : low[i];
+                high[next] = j < keys.size() ? keys[j] : high[i];
+                next++;
+            }
+        }
+        if (next != nodes.size()) return false;
+        root = nodes[0];
+        return true;
+    }
+}
@@ -0,0 +1,259 @@
+﻿#pragma once
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include "NodeSearch.h"
+
+// 編譯期決定階數的 B-tree：鍵值與子節點指標直接存放在節點內的固定陣列，
+// 節點對齊快取線，一次探訪只需讀取節點本身，不必再經過 std::vector 的額外緩衝區
+// MaxKeys / MinKeys 為非根節點鍵值數的上下限，需滿足 2 * MinKeys + 1 <= MaxKeys 才能安全合併
+template <int MaxKeys, int MinKeys>
+class StaticTree {
+    static_assert(MinKeys >= 1 && 2 * MinKeys + 1 <= MaxKeys, "StaticTree 的階數過小");
+
+public:
+    // 固定大小的節點，count 為目前的鍵值數
+    struct alignas(64) Node {
+        int count;
+        bool leaf;
+        int keys[MaxKeys];
+        Node* children[MaxKeys + 1];
+
+        explicit Node(bool leaf) : count(0), leaf(leaf), keys() {} // rankFixed 會讀取整個 keys 陣列，未使用的欄位也需初始化
+    };
+
+private:
+    Node* root; // 樹的根節點
+
+    // 節點中第一個大於 key 的位置 (與 insertNonFull 的由後往前掃描相同語意)
+    static int upperRank(const Node* node, int key) {
+        int i = nodesearch::rankFixed<MaxKeys>(node->keys, node->count, key);
+        while (i < node->count && node->keys[i] == key) i++;
+        return i;
+    }
+
+    // 將 parent 的第 i 個 (已滿的) 子節點分裂成兩個
+    void splitChild(Node* parent, int i) {
+        constexpr int mid = MaxKeys / 2;
+        Node* y = parent->children[i];
+        Node* z = new Node(y->leaf);
+
+        z->count = MaxKeys - mid - 1;
+        std::copy(y->keys + mid + 1, y->keys + MaxKeys, z->keys); // 右半部鍵值移到 z
+        if (!y->leaf) {
+            std::copy(y->children + mid + 1, y->children + MaxKeys + 1, z->children); // 右半部子節點移到 z
+        }
+        y->count = mid;
+
+        // 父節點騰出位置後放入中間鍵值與 z
+        std::copy_backward(parent->keys + i, parent->keys + parent->count, parent->keys + parent->count + 1);
+        std::copy_backward(parent->children + i + 1, parent->children + parent->count + 1, parent->children + parent->count + 2);
+        parent->keys[i] = y->keys[mid];
+        parent->children[i + 1] = z;
+        parent->count++;
+    }
+
+    // 插入鍵值到非滿節點，沿途預先分裂已滿的子節點
+    void insertNonFull(Node* node, int key) {
+        while (!node->leaf) {
+            int i = upperRank(node, key);
+            if (node->children[i]->count == MaxKeys) {
+                splitChild(node, i);
+                if (key > node->keys[i]) i++;
+            }
+            node = node->children[i];
+        }
+        int i = upperRank(node, key);
+        std::copy_backward(node->keys + i, node->keys + node->count, node->keys + node->count + 1);
+        node->keys[i] = key;
+        node->count++;
+    }
+
+    // 從左兄弟借用鍵值
+    void borrowFromPrev(Node* node, int idx) {
+        Node* child = node->children[idx];
+        Node* sibling = node->children[idx - 1];
+
+        std::copy_backward(child->keys, child->keys + child->count, child->keys + child->count + 1);
+        child->keys[0] = node->keys[idx - 1];
+        if (!child->leaf) {
+            std::copy_backward(child->children, child->children + child->count + 1, child->children + child->count + 2);
+            child->children[0] = sibling->children[sibling->count];
+        }
+        node->keys[idx - 1] = sibling->keys[sibling->count - 1];
+        sibling->count--;
+        child->count++;
+    }
+
+    // 從右兄弟借用鍵值
+    void borrowFromNext(Node* node, int idx) {
+        Node* child = node->children[idx];
+        Node* sibling = node->children[idx + 1];
+
+        child->keys[child->count] = node->keys[idx];
+        if (!child->leaf) {
+            child->children[child->count + 1] = sibling->children[0];
+            std::copy(sibling->children + 1, sibling->children + sibling->count + 1, sibling->children);
+        }
+        node->keys[idx] = sibling->keys[0];
+        std::copy(sibling->keys + 1, sibling->keys + sibling->count, sibling->keys);
+        sibling->count--;
+        child->count++;
+    }
+
+    // 將第 idx 個子節點、父節點鍵值與右兄弟合併
+    void merge(Node* node, int idx) {
+        Node* child = node->children[idx];
+        Node* sibling = node->children[idx + 1];
+
+        child->keys[child->count] = node->keys[idx];
+        std::copy(sibling->keys, sibling->keys + sibling->count, child->keys + child->count + 1);
+        if (!child->leaf) {
+            std::copy(sibling->children, sibling->children + sibling->count + 1, child->children + child->count + 1);
+        }
+        child->count += sibling->count + 1;
+
+        std::copy(node->keys + idx + 1, node->keys + node->count, node->keys + idx);
+        std::copy(node->children + idx + 2, node->children + node->count + 1, node->children + idx + 1);
+        node->count--;
+        delete sibling;
+    }
+
+    // 讓第 idx 個子節點至少有 MinKeys + 1 個鍵值，回傳接下來應進入的子節點位置
+    int fill(Node* node, int idx) {
+        if (idx != 0 && node->children[idx - 1]->count > MinKeys) {
+            borrowFromPrev(node, idx);
+        }
+        else if (idx != node->count && node->children[idx + 1]->count > MinKeys) {
+            borrowFromNext(node, idx);
+        }
+        else if (idx != node->count) {
+            merge(node, idx);
+        }
+        else {
+            merge(node, idx - 1);
+            idx--;
+        }
+        return idx;
+    }
+
+    // 由上而下刪除，進入子節點前確保其鍵值足夠，因此不需回溯
+    bool remove(Node* node, int key) {
+        while (true) {
+            int idx = nodesearch::rankFixed<MaxKeys>(node->keys, node->count, key);
+            if (idx < node->count && node->keys[idx] == key) {
+                if (node->leaf) {
+                    std::copy(node->keys + idx + 1, node->keys + node->count, node->keys + idx);
+                    node->count--;
+                    return true;
+                }
+                Node* left = node->children[idx];
+                Node* right = node->children[idx + 1];
+                if (left->count > MinKeys) { // 以前驅鍵值取代後，改為刪除前驅
+                    Node* cur = left;
+                    while (!cur->leaf) cur = cur->children[cur->count];
+                    key = node->keys[idx] = cur->keys[cur->count - 1];
+                    node = left;
+                }
+                else if (right->count > MinKeys) { // 以後繼鍵值取代後，改為刪除後繼
+                    Node* cur = right;
+                    while (!cur->leaf) cur = cur->children[0];
+                    key = node->keys[idx] = cur->keys[0];
+                    node = right;
+                }
+                else { // 左右子節點都不足，合併後在合併的節點中繼續刪除
+                    merge(node, idx);
+                    node = left;
+                }
+                continue;
+            }
+            if (node->leaf) return false;
+            if (node->children[idx]->count <= MinKeys) {
+                idx = fill(node, idx);
+            }
+            node = node->children[idx];
+        }
+    }
+
+    // 遞迴地打印樹的結構
+    void printTree(const Node* node, int level) const {
+        std::cout << std::string(level * 4, ' ');
+        for (int i = 0; i < node->count; i++) std::cout << node->keys[i] << " ";
+        std::cout << "\n";
+        if (node->leaf) return;
+        for (int i = 0; i <= node->count; i++) printTree(node->children[i], level + 1);
+    }
+
+    // 遞迴釋放整棵子樹
+    static void freeNodes(Node* node) {
+        if (!node) return;
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; i++) freeNodes(node->children[i]);
+        }
+        delete node;
+    }
+
+public:
+    StaticTree() : root(nullptr) {}
+    ~StaticTree() { freeNodes(root); }
+    StaticTree(const StaticTree&) = delete;
+    StaticTree& operator=(const StaticTree&) = delete;
+
+    // 插入鍵值
+    void insert(int key) {
+        if (!root) {
+            root = new Node(true);
+        }
+        else if (root->count == MaxKeys) { // 根節點已滿時先分裂，樹高加一
+            Node* newRoot = new Node(false);
+            newRoot->children[0] = root;
+            root = newRoot;
+            splitChild(root, 0);
+        }
+        insertNonFull(root, key);
+    }
+
+    // 刪除鍵值，回傳是否找到
+    bool remove(int key) {
+        if (!root) return false;
+        bool found = remove(root, key);
+        if (root->count == 0) { // 根節點已空，樹高減一
+            Node* old = root;
+            root = root->leaf ? nullptr : root->children[0];
+            delete old;
+        }
+        return found;
+    }
+
+    // 查詢鍵值，找到時回傳指向該鍵值的指標，否則回傳 nullptr
+    const int* find(int key) const {
+        const Node* node = root;
+        while (node) {
+            int i = nodesearch::rankFixed<MaxKeys>(node->keys, node->count, key);
+            if (i < node->count && node->keys[i] == key) return &node->keys[i];
+            if (node->leaf) return nullptr;
+            node = node->children[i];
+        }
+        return nullptr;
+    }
+
+    // 判斷鍵值是否存在
+    bool contains(int key) const {
+        return find(key) != nullptr;
+    }
+
+    // 打印整棵樹
+    void printTree() const {
+        if (root) printTree(root, 0);
+    }
+};
+
+// 最小度數為 T 的 B-tree：每個非根節點有 T-1 ~ 2T-1 個鍵值
+template <int T>
+using StaticBTree = StaticTree<2 * T - 1, T - 1>;
+
+// 階數為 M 的 m-way 搜尋樹，規則與 MWayTree 相同：每個節點最多 M-1 個鍵值，滿了就在 (M-1)/2 分裂，
+// 刪除時子節點少於 M/2 個鍵值才借用或合併；因此葉節點同深度，與 MWayTree 一樣實際上是 M 階的 B-tree。
+// MWayTree 在 M = 3 時會產生沒有鍵值的節點，這裡不支援，M 至少為 4
+template <int M>
+using StaticMWayTree = StaticTree<M - 1, M / 2 - 1>;
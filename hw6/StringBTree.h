@@ -0,0 +1,451 @@
+﻿#pragma once
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include "NodePool.h"
+
+namespace strkey {
+    constexpr size_t kPageSize = 4096; // 每個節點的頁面大小 (位元組)
+    constexpr size_t kMaxKeyLength = 1000; // 鍵值長度上限，確保分裂後的兩半都放得進一頁
+
+    // 頁面中每個鍵值的欄位，依鍵值順序排在頁面開頭
+    struct Slot {
+        uint16_t offset; // 去掉共同前綴後的尾段在頁面中的位置
+        uint16_t length; // 尾段長度
+        uint32_t head; // 尾段的前 4 個位元組 (big-endian，不足補 0)，多數比較不必讀取尾段
+    };
+
+    // 字串前 4 個位元組組成的整數：兩個字串的 head 不同時，大小關係與字串本身相同
+    inline uint32_t head(std::string_view s) {
+        uint32_t h = 0;
+        for (size_t i = 0; i < 4; i++) h = h << 8 | (i < s.size() ? static_cast<unsigned char>(s[i]) : 0u);
+        return h;
+    }
+
+    inline size_t commonPrefix(std::string_view a, std::string_view b) {
+        size_t n = std::min(a.size(), b.size()), i = 0;
+        while (i < n && a[i] == b[i]) i++;
+        return i;
+    }
+
+    // 大於 left 且不大於 right 的最短字串 (需 left < right)：right 取到第一個與 left 不同的字元為止
+    inline std::string_view shortestSeparator(std::string_view left, std::string_view right) {
+        return right.substr(0, commonPrefix(left, right) + 1);
+    }
+}
+
+// 字串鍵值 B+-tree 的節點：一個固定大小的 slotted page。節點內所有鍵值的共同前綴只存一次 (放在頁面最尾端)，
+// slot 陣列由頁面開頭往後長，去掉前綴的尾段由尾端往前放
+struct StringNode {
+    bool leaf; // 是否為葉節點
+    uint16_t count = 0; // 鍵值 (葉節點) 或分隔鍵 (內部節點) 的個數
+    uint16_t prefixLength = 0; // 共同前綴長度
+    uint16_t heapStart = strkey::kPageSize; // 尾段區 (含前綴) 的起點
+    uint16_t deadBytes = 0; // 刪除的鍵值留在尾段區的位元組數，重建頁面時才回收
+    std::vector<StringNode*> children; // 內部節點的子節點，共 count + 1 個
+    alignas(8) unsigned char data[strkey::kPageSize];
+
+    explicit StringNode(bool leaf) : leaf(leaf) {}
+
+    // 由 NodePool 重複使用節點時重新初始化
+    void reset(bool leaf) {
+        this->leaf = leaf;
+        count = 0;
+        prefixLength = 0;
+        heapStart = strkey::kPageSize;
+        deadBytes = 0;
+        children.clear();
+    }
+
+    strkey::Slot* slots() { return reinterpret_cast<strkey::Slot*>(data); }
+    const strkey::Slot* slots() const { return reinterpret_cast<const strkey::Slot*>(data); }
+
+    std::string_view prefix() const {
+        return { reinterpret_cast<const char*>(data) + strkey::kPageSize - prefixLength, prefixLength };
+    }
+
+    std::string_view suffix(int i) const {
+        const strkey::Slot& slot = slots()[i];
+        return { reinterpret_cast<const char*>(data) + slot.offset, slot.length };
+    }
+
+    // 第 i 個完整的鍵值 (前綴加上尾段)
+    std::string key(int i) const {
+        std::string k(prefix());
+        k += suffix(i);
+        return k;
+    }
+
+    // slot 陣列與尾段區之間的空間
+    size_t freeSpace() const {
+        return heapStart - count * sizeof(strkey::Slot);
+    }
+
+    // 實際使用的位元組數 (不含已刪除的尾段)
+    size_t usedBytes() const {
+        return strkey::kPageSize - freeSpace() - deadBytes;
+    }
+};
+
+// 字串鍵值 B+-tree 的形狀統計
+struct StringTreeStats {
+    int height = 0;
+    size_t leafNodes = 0;
+    size_t internalNodes = 0;
+    size_t keys = 0;
+    size_t separators = 0; // 內部節點的分隔鍵總數
+    size_t separatorBytes = 0; // 分隔鍵還原成完整字串後的總長度
+    size_t pageBytesUsed = 0; // 所有頁面實際使用的位元組數
+    size_t bytes = 0; // 節點佔用的記憶體
+
+    double fillFactor() const {
+        size_t nodes = leafNodes + internalNodes;
+        return nodes ? static_cast<double>(pageBytesUsed) / (nodes * strkey::kPageSize) : 0.0;
+    }
+
+    double averageSeparatorLength() const {
+        return separators ? static_cast<double>(separatorBytes) / separators : 0.0;
+    }
+};
+
+// 以字串為鍵值的 B+-tree (鍵值不重複)：每個節點是一個 slotted page，節點內的鍵值做共同前綴壓縮；
+// 節點依位元組數而非鍵值個數決定是否分裂，葉節點分裂時只把「能區分兩半的最短前綴」上移成分隔鍵，
+// 內部節點因此能放更多、更短的分隔鍵，扇出變大、樹變矮
+class StringBTree {
+    StringNode* root = nullptr;
+    size_t count = 0; // 鍵值總數
+    NodePool<StringNode> pool{ 64 }; // 所有節點皆由此配置
+
+    // 子節點分裂後交給父節點的新右半節點與分隔鍵
+    struct Split {
+        std::string separator;
+        StringNode* right = nullptr;
+    };
+
+    // 節點中第一個不小於 key 的位置；exact 表示該位置的鍵值是否等於 key
+    static int lowerBound(const StringNode* node, std::string_view key, bool& exact) {
+        exact = false;
+        std::string_view prefix = node->prefix();
+        int c = key.substr(0, prefix.size()).compare(prefix);
+        if (c < 0) return 0; // key 小於節點內所有鍵值
+        if (c > 0) return node->count; // key 大於節點內所有鍵值
+        std::string_view rest = key.substr(prefix.size());
+        uint32_t h = strkey::head(rest);
+        const strkey::Slot* slots = node->slots();
+        int lo = 0, hi = node->count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            bool less = slots[mid].head < h || (slots[mid].head == h && node->suffix(mid) < rest);
+            if (less) lo = mid + 1;
+            else hi = mid;
+        }
+        exact = lo < node->count && slots[lo].head == h && node->suffix(lo) == rest;
+        return lo;
+    }
+
+    // 內部節點中小於等於 key 的分隔鍵個數，即 key 所在的子節點位置
+    static int childIndex(const StringNode* node, std::string_view key) {
+        bool exact;
+        int i = lowerBound(node, key, exact);
+        return exact ? i + 1 : i;
+    }
+
+    // 節點內所有完整的鍵值
+    static std::vector<std::string> keysOf(const StringNode* node) {
+        std::vector<std::string> keys;
+        keys.reserve(node->count + 1);
+        for (int i = 0; i < node->count; i++) keys.push_back(node->key(i));
+        return keys;
+    }
+
+    // 在第 i 個位置放入尾段 rest，呼叫前需確認空間足夠
+    static void place(StringNode* node, int i, std::string_view rest) {
+        node->heapStart = static_cast<uint16_t>(node->heapStart - rest.size());
+        std::memcpy(node->data + node->heapStart, rest.data(), rest.size());
+        strkey::Slot* slots = node->slots();
+        std::memmove(slots + i + 1, slots + i, (node->count - i) * sizeof(strkey::Slot));
+        slots[i] = { node->heapStart, static_cast<uint16_t>(rest.size()), strkey::head(rest) };
+        node->count++;
+    }
+
+    // 刪除第 i 個鍵值的 slot，尾段留到重建頁面時回收
+    static void erase(StringNode* node, int i) {
+        strkey::Slot* slots = node->slots();
+        node->deadBytes = static_cast<uint16_t>(node->deadBytes + slots[i].length);
+        std::memmove(slots + i, slots + i + 1, (node->count - i - 1) * sizeof(strkey::Slot));
+        node->count--;
+    }
+
+    // 以已排序的 keys[first, last) 重新寫入整個頁面，共同前綴取第一個與最後一個鍵值的共同前綴
+    static void build(StringNode* node, const std::vector<std::string>& keys, size_t first, size_t last) {
+        node->count = 0;
+        node->deadBytes = 0;
+        size_t prefix = first < last ? strkey::commonPrefix(keys[first], keys[last - 1]) : 0;
+        node->prefixLength = static_cast<uint16_t>(prefix);
+        node->heapStart = static_cast<uint16_t>(strkey::kPageSize - prefix);
+        if (prefix) std::memcpy(node->data + node->heapStart, keys[first].data(), prefix);
+        for (size_t i = first; i < last; i++) place(node, node->count, std::string_view(keys[i]).substr(prefix));
+    }
+
+    // keys[first, last) 寫成一個頁面所需的位元組數；prefixSums[i] 為前 i 個鍵值的 slot 與完整長度總和
+    static size_t encodedSize(const std::vector<std::string>& keys, const std::vector<size_t>& prefixSums, size_t first, size_t last) {
+        if (first == last) return 0;
+        size_t prefix = strkey::commonPrefix(keys[first], keys[last - 1]);
+        return prefixSums[last] - prefixSums[first] - (last - first - 1) * prefix;
+    }
+
+    static std::vector<size_t> sizeSums(const std::vector<std::string>& keys) {
+        std::vector<size_t> sums(keys.size() + 1, 0);
+        for (size_t i = 0; i < keys.size(); i++) sums[i + 1] = sums[i] + sizeof(strkey::Slot) + keys[i].size();
+        return sums;
+    }
+
+    // 選擇分裂位置 s：先找位元組數大約平分的位置，再在附近 (約 1/8 的鍵值) 挑上移的分隔鍵最短、兩半都放得下的位置。
+    // 葉節點分成 [0, s) 與 [s, n)；內部節點的 keys[s] 上移，分成 [0, s) 與 [s+1, n)
+    static size_t chooseSplit(const std::vector<std::string>& keys, bool leaf) {
+        size_t n = keys.size();
+        std::vector<size_t> sums = sizeSums(keys);
+        size_t lo = 1, hi = leaf ? n - 1 : n - 2;
+        size_t middle = std::upper_bound(sums.begin(), sums.end(), sums[n] / 2) - sums.begin() - 1;
+        middle = std::min(std::max(middle, lo), hi);
+
+        auto fits = [&](size_t s) {
+            return encodedSize(keys, sums, 0, s) <= strkey::kPageSize && encodedSize(keys, sums, leaf ? s : s + 1, n) <= strkey::kPageSize;
+        };
+        auto separatorLength = [&](size_t s) {
+            return leaf ? strkey::commonPrefix(keys[s - 1], keys[s]) + 1 : keys[s].size();
+        };
+        size_t window = n / 16;
+        size_t first = middle > lo + window ? middle - window : lo;
+        size_t last = std::min(middle + window, hi);
+        size_t best = 0, bestLength = SIZE_MAX, bestDistance = SIZE_MAX;
+        for (size_t s = first; s <= last; s++) {
+            if (!fits(s)) continue;
+            size_t length = separatorLength(s), distance = s > middle ? s - middle : middle - s;
+            if (length < bestLength || (length == bestLength && distance < bestDistance)) {
+                best = s;
+                bestLength = length;
+                bestDistance = distance;
+            }
+        }
+        if (best == 0) { // 理論上不會發生 (見 kMaxKeyLength)，保險起見找任一個放得下的位置
+            for (size_t s = lo; s <= hi && best == 0; s++) {
+                if (fits(s)) best = s;
+            }
+        }
+        return best ? best : middle;
+    }
+
+    // 在 node 的第 i 個位置放入 key (內部節點同時把 right 放在第 i+1 個子節點)；
+    // 放不下時分裂 node，回傳 true 並把新的右半節點與分隔鍵填入 split
+    bool insertEntry(StringNode* node, int i, std::string_view key, StringNode* right, Split& split) {
+        std::string_view prefix = node->prefix();
+        if (key.substr(0, prefix.size()) == prefix && sizeof(strkey::Slot) + key.size() - prefix.size() <= node->freeSpace()) {
+            place(node, i, key.substr(prefix.size()));
+            if (right) node->children.insert(node->children.begin() + i + 1, right);
+            return false;
+        }
+
+        // 共同前綴變短或尾段區需要整理：解開所有鍵值後重建頁面，仍放不下時才分裂
+        std::vector<std::string> keys = keysOf(node);
+        keys.insert(keys.begin() + i, std::string(key));
+        if (right) node->children.insert(node->children.begin() + i + 1, right);
+        std::vector<size_t> sums = sizeSums(keys);
+        if (encodedSize(keys, sums, 0, keys.size()) <= strkey::kPageSize) {
+            build(node, keys, 0, keys.size());
+            return false;
+        }
+
+        size_t s = chooseSplit(keys, node->leaf);
+        StringNode* sibling = pool.create(node->leaf);
+        if (node->leaf) {
+            split.separator = strkey::shortestSeparator(keys[s - 1], keys[s]);
+            build(sibling, keys, s, keys.size());
+        }
+        else {
+            split.separator = keys[s]; // 中間的分隔鍵上移
+            sibling->children.assign(node->children.begin() + s + 1, node->children.end());
+            node->children.resize(s + 1);
+            build(sibling, keys, s + 1, keys.size());
+        }
+        build(node, keys, 0, s);
+        split.right = sibling;
+        return true;
+    }
+
+    // 由下而上插入：葉節點放入 key，子節點分裂時把分隔鍵插入本節點；本節點也分裂時回傳 true
+    bool insert(StringNode* node, std::string_view key, bool& inserted, Split& split) {
+        if (node->leaf) {
+            bool exact;
+            int i = lowerBound(node, key, exact);
+            inserted = !exact;
+            return inserted && insertEntry(node, i, key, nullptr, split);
+        }
+        int i = childIndex(node, key);
+        Split below;
+        if (!insert(node->children[i], key, inserted, below)) return false;
+        return insertEntry(node, i, below.separator, below.right, split);
+    }
+
+    // 第 i 個子節點使用不到四分之一頁時，嘗試與左或右兄弟合併成一頁；兩邊都放不下就維持原狀
+    void rebalance(StringNode* node, int i) {
+        if (node->children[i]->usedBytes() >= strkey::kPageSize / 4) return;
+        for (int left : { i - 1, i }) {
+            if (left < 0 || left >= node->count) continue;
+            StringNode* l = node->children[left];
+            StringNode* r = node->children[left + 1];
+            std::vector<std::string> keys = keysOf(l);
+            if (!l->leaf) keys.push_back(node->key(left)); // 內部節點的分隔鍵下移；葉節點的分隔鍵只是路標，直接捨棄
+            for (int k = 0; k < r->count; k++) keys.push_back(r->key(k));
+            if (encodedSize(keys, sizeSums(keys), 0, keys.size()) > strkey::kPageSize) continue;
+
+            if (!l->leaf) l->children.insert(l->children.end(), r->children.begin(), r->children.end());
+            build(l, keys, 0, keys.size());
+            erase(node, left);
+            node->children.erase(node->children.begin() + left + 1);
+            pool.destroy(r);
+            return;
+        }
+    }
+
+    // 從 node 的子樹刪除 key，回傳是否找到；找不到時不會合併任何節點
+    bool remove(StringNode* node, std::string_view key) {
+        if (node->leaf) {
+            bool exact;
+            int i = lowerBound(node, key, exact);
+            if (exact) erase(node, i);
+            return exact;
+        }
+        int i = childIndex(node, key);
+        if (!remove(node->children[i], key)) return false;
+        rebalance(node, i);
+        return true;
+    }
+
+    // 中序走訪 node 子樹內落在 [lo, hi] 的鍵值；遇到大於 hi 的鍵值時回傳 false 表示可以停止
+    template <typename Fn>
+    static bool forEachInRange(const StringNode* node, std::string_view lo, std::string_view hi, Fn& fn, std::string& buffer) {
+        if (!node->leaf) {
+            int last = childIndex(node, hi);
+            for (int i = childIndex(node, lo); i <= last; i++) {
+                if (!forEachInRange(node->children[i], lo, hi, fn, buffer)) return false;
+            }
+            return true;
+        }
+        bool exact;
+        std::string_view prefix = node->prefix();
+        buffer.assign(prefix);
+        for (int i = lowerBound(node, lo, exact); i < node->count; i++) {
+            buffer.resize(prefix.size());
+            buffer += node->suffix(i);
+            if (std::string_view(buffer) > hi) return false;
+            fn(std::string_view(buffer));
+        }
+        return true;
+    }
+
+    static void collect(const StringNode* node, int depth, StringTreeStats& stats) {
+        stats.height = std::max(stats.height, depth + 1);
+        stats.pageBytesUsed += node->usedBytes();
+        stats.bytes += sizeof(StringNode) + node->children.capacity() * sizeof(StringNode*);
+        if (node->leaf) {
+            stats.leafNodes++;
+            stats.keys += node->count;
+            return;
+        }
+        stats.internalNodes++;
+        stats.separators += node->count;
+        stats.separatorBytes += node->count * node->prefixLength;
+        for (int i = 0; i < node->count; i++) stats.separatorBytes += node->suffix(i).size();
+        for (const StringNode* child : node->children) collect(child, depth + 1, stats);
+    }
+
+    // 遞迴地打印樹的結構：[共同前綴] 之後為各鍵值的尾段，葉節點以 * 標示
+    static void printTree(const StringNode* node, int level) {
+        std::cout << std::string(level * 4, ' ') << "[" << node->prefix() << "]";
+        for (int i = 0; i < node->count; i++) std::cout << " " << node->suffix(i);
+        std::cout << (node->leaf ? " *\n" : "\n");
+        for (const StringNode* child : node->children) printTree(child, level + 1);
+    }
+
+public:
+    StringBTree() = default;
+
+    ~StringBTree() = default;
+    StringBTree(const StringBTree&) = delete;
+    StringBTree& operator=(const StringBTree&) = delete;
+
+    // 插入鍵值，鍵值已存在時回傳 false；鍵值長度超過 strkey::kMaxKeyLength 時擲出 std::length_error
+    bool insert(std::string_view key) {
+        if (key.size() > strkey::kMaxKeyLength) throw std::length_error("StringBTree 的鍵值過長");
+        if (!root) root = pool.create(true);
+        bool inserted = false;
+        Split split;
+        if (insert(root, key, inserted, split)) { // 根節點分裂，樹高加一
+            StringNode* newRoot = pool.create(false);
+            newRoot->children = { root, split.right };
+            std::vector<std::string> separator{ split.separator };
+            build(newRoot, separator, 0, 1);
+            root = newRoot;
+        }
+        if (inserted) count++;
+        return inserted;
+    }
+
+    // 刪除鍵值，找不到時回傳 false 且不修改樹
+    bool remove(std::string_view key) {
+        if (!root || !remove(root, key)) return false;
+        count--;
+        if (root->count == 0) { // 根節點已空，樹高減一
+            StringNode* old = root;
+            root = root->leaf ? nullptr : root->children[0];
+            pool.destroy(old);
+        }
+        return true;
+    }
+
+    // 判斷鍵值是否存在
+    bool contains(std::string_view key) const {
+        const StringNode* node = root;
+        if (!node) return false;
+        while (!node->leaf) node = node->children[childIndex(node, key)];
+        bool exact;
+        lowerBound(node, key, exact);
+        return exact;
+    }
+
+    // 依序對 [lo, hi] 內的每個鍵值呼叫 fn(std::string_view)，傳入的字串只在該次呼叫內有效
+    template <typename Fn>
+    void forEachInRange(std::string_view lo, std::string_view hi, Fn fn) const {
+        std::string buffer;
+        if (root && lo <= hi) forEachInRange(root, lo, hi, fn, buffer);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // 樹高、節點數、分隔鍵的平均長度與頁面使用率；需走訪所有節點
+    StringTreeStats stats() const {
+        StringTreeStats result;
+        if (root) collect(root, 0, result);
+        return result;
+    }
+
+    // 清空整棵樹
+    void clear() {
+        root = nullptr;
+        count = 0;
+        pool.reset();
+    }
+
+    // 打印整棵樹
+    void printTree() const {
+        if (root) printTree(root, 0);
+    }
+};
@@ -0,0 +1,197 @@
+﻿#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+
+// 工作竊取 (work-stealing) 執行緒池：每個工作執行緒有自己的佇列，從尾端取出自己最新的工作，
+// 閒置時從其他佇列的前端偷取較舊 (通常也較大) 的工作；由外部執行緒送出的工作輪流分配到各佇列
+class ThreadPool {
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{ false };
+    std::atomic<size_t> queued{ 0 }; // 尚未被取走的工作數
+    std::atomic<size_t> nextQueue{ 0 };
+    std::mutex sleepLock;
+    std::condition_variable wake;
+
+    // 目前執行緒所屬的執行緒池與佇列編號，外部執行緒為 nullptr
+    static inline thread_local ThreadPool* currentPool = nullptr;
+    static inline thread_local size_t currentIndex = 0;
+
+    bool popFrom(size_t index, bool back, std::function<void()>& task) {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty()) return false;
+        if (back) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued--;
+        return true;
+    }
+
+    void workerLoop(size_t index) {
+        currentPool = this;
+        currentIndex = index;
+        while (!stopping) {
+            if (runOne()) continue;
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [&] { return stopping || queued > 0; });
+        }
+    }
+
+public:
+    explicit ThreadPool(unsigned threads = std::max(1u, std::thread::hardware_concurrency())) {
+        threads = std::max(1u, threads);
+        for (unsigned i = 0; i < threads; i++) queues.push_back(std::make_unique<Queue>());
+        for (unsigned i = 0; i < threads; i++) workers.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // 送出一個工作；工作執行緒送出的工作放在自己的佇列
+    void submit(std::function<void()> task) {
+        size_t index = currentPool == this ? currentIndex : nextQueue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> guard(queues[index]->lock);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> guard(sleepLock); // 避免與 workerLoop 的檢查交錯而錯過喚醒
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    // 執行一個待處理的工作 (先找自己的佇列，再向其他佇列偷取)，沒有工作時回傳 false
+    bool runOne() {
+        if (queued == 0) return false;
+        std::function<void()> task;
+        size_t self = currentPool == this ? currentIndex : 0;
+        bool found = currentPool == this && popFrom(self, true, task);
+        for (size_t i = 1; !found && i <= queues.size(); i++) {
+            found = popFrom((self + i) % queues.size(), false, task);
+        }
+        if (!found) return false;
+        task();
+        return true;
+    }
+};
+
+// 一組 fork-join 工作：wait() 期間呼叫端也會協助執行池中的工作，因此可以在工作中巢狀使用
+class TaskGroup {
+    ThreadPool& pool;
+    std::atomic<size_t> remaining{ 0 };
+
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+
+    ~TaskGroup() {
+        wait();
+    }
+
+    template <typename Fn>
+    void run(Fn fn) {
+        remaining++;
+        pool.submit([this, fn = std::move(fn)]() mutable {
+            fn();
+            remaining--;
+        });
+    }
+
+    void wait() {
+        while (remaining > 0) {
+            if (!pool.runOne()) std::this_thread::yield();
+        }
+    }
+};
+
+// 將 [begin, end) 切成約 grain 大小的區段平行執行 fn(rangeBegin, rangeEnd)
+template <typename Fn>
+void parallelFor(size_t begin, size_t end, size_t grain, Fn fn, ThreadPool& pool) {
+    grain = std::max<size_t>(grain, 1);
+    if (end - begin <= grain) {
+        fn(begin, end);
+        return;
+    }
+    TaskGroup group(pool);
+    for (size_t chunk = begin; chunk < end; chunk += grain) {
+        size_t chunkEnd = std::min(end, chunk + grain);
+        group.run([&fn, chunk, chunkEnd] { fn(chunk, chunkEnd); });
+    }
+    group.wait();
+}
+
+// 平行排序：各區段分別排序後，逐輪兩兩合併；每次合併再依 a 的分割點與 b 中對應位置切成數段平行處理
+template <typename T>
+void parallelSort(std::vector<T>& data, ThreadPool& pool) {
+    size_t n = data.size();
+    size_t chunks = 1;
+    while (chunks < pool.size() * 2) chunks *= 2; // 合併輪數需為整數，區段數取 2 的冪次
+    if (pool.size() == 1 || n < chunks * 4096) {
+        std::sort(data.begin(), data.end());
+        return;
+    }
+
+    auto boundary = [&](size_t i) { return n * i / chunks; };
+    parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) std::sort(data.begin() + boundary(c), data.begin() + boundary(c + 1));
+    }, pool);
+
+    std::unique_ptr<T[]> buffer(new T[n]); // 不預先初始化，由合併的各段平行寫入
+    T* source = data.data();
+    T* target = buffer.get();
+    for (size_t width = 1; width < chunks; width *= 2) {
+        size_t pairs = chunks / (2 * width);
+        size_t pieces = std::max<size_t>(1, pool.size() * 4 / pairs); // 每對再切成幾段
+        TaskGroup group(pool);
+        for (size_t p = 0; p < pairs; p++) {
+            size_t aBegin = boundary(2 * p * width), aEnd = boundary((2 * p + 1) * width), bEnd = boundary((2 * p + 2) * width);
+            for (size_t piece = 0; piece < pieces; piece++) {
+                group.run([=] {
+                    size_t aLength = aEnd - aBegin;
+                    size_t a0 = aBegin + aLength * piece / pieces, a1 = aBegin + aLength * (piece + 1) / pieces;
+                    // b 中對應的位置：小於 a[a0] 的元素都屬於前面的段
+                    size_t b0 = piece == 0 ? aEnd : std::lower_bound(source + aEnd, source + bEnd, source[a0]) - source;
+                    size_t b1 = piece + 1 == pieces ? bEnd : std::lower_bound(source + aEnd, source + bEnd, source[a1]) - source;
+                    std::merge(source + a0, source + a1, source + b0, source + b1, target + (a0 - aBegin) + (b0 - aEnd) + aBegin);
+                });
+            }
+        }
+        group.wait();
+        std::swap(source, target);
+    }
+    if (source != data.data()) {
+        parallelFor(0, n, n / (pool.size() * 4) + 1, [&](size_t first, size_t last) {
+            std::copy(source + first, source + last, data.data() + first);
+        }, pool);
+    }
+}
@@ -0,0 +1,202 @@
+﻿#pragma once
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <limits>
+
+// 大型樹的文字輸出與匯出：內容先寫入一塊緩衝區，累積到一定大小才一次交給 ostream，
+// 不必對每個鍵值各呼叫一次 operator<<。Node 需有 keys 與 children，isLeaf(node) 判斷葉節點 (與 computeShape 相同)
+namespace render {
+
+    // 輸出範圍：只輸出前 maxDepth 層、每層最左邊的 maxNodesPerLevel 個節點與每個節點的前 maxKeysPerNode 個鍵值
+    struct Limits {
+        int maxDepth = std::numeric_limits<int>::max();
+        size_t maxNodesPerLevel = std::numeric_limits<size_t>::max();
+        size_t maxKeysPerNode = std::numeric_limits<size_t>::max();
+    };
+
+    // 寫滿 kCapacity 才送出的輸出緩衝區，解構時送出剩餘的內容
+    class OutputBuffer {
+        static constexpr size_t kCapacity = 1 << 16;
+        std::ostream& out;
+        std::string buffer;
+
+        void spill() {
+            if (buffer.size() >= kCapacity) flush();
+        }
+
+    public:
+        explicit OutputBuffer(std::ostream& out) : out(out) {
+            buffer.reserve(kCapacity + 64);
+        }
+        ~OutputBuffer() {
+            flush();
+        }
+        OutputBuffer(const OutputBuffer&) = delete;
+        OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+        OutputBuffer& operator<<(std::string_view text) {
+            buffer.append(text);
+            spill();
+            return *this;
+        }
+
+        OutputBuffer& operator<<(char c) {
+            buffer.push_back(c);
+            spill();
+            return *this;
+        }
+
+        template <std::integral Int>
+        OutputBuffer& operator<<(Int value) {
+            char digits[24];
+            buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+            spill();
+            return *this;
+        }
+
+        void flush() {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
+
+    // 以縮排表示層次的前序輸出 (printTree 的格式)：每個節點一行，鍵值之間以空白分隔
+    template <typename Node, typename IsLeaf>
+    void indented(OutputBuffer& out, const Node* node, int level, IsLeaf& isLeaf) {
+        for (int i = 0; i < level * 4; i++) out << ' ';
+        for (int key : node->keys) out << key << ' ';
+        out << '\n';
+        if (isLeaf(node)) return;
+        for (size_t i = 0; i <= node->keys.size(); i++) indented(out, node->children[i], level + 1, isLeaf);
+    }
+
+    template <typename Node, typename IsLeaf>
+    void printIndented(std::ostream& stream, const Node* root, IsLeaf isLeaf) {
+        OutputBuffer out(stream);
+        if (root) indented(out, root, 0, isLeaf);
+    }
+
+    // 輸出節點的前 limit 個鍵值，回傳實際輸出的個數
+    template <typename Node>
+    size_t keyList(OutputBuffer& out, const Node* node, size_t limit, char separator) {
+        size_t shown = std::min(node->keys.size(), limit);
+        for (size_t i = 0; i < shown; i++) {
+            if (i) out << separator;
+            out << node->keys[i];
+        }
+        return shown;
+    }
+
+    // 逐層輸出，每層一行："第 d 層 (n 個節點): [k1 k2] [k3] ..."；
+    // 整層的節點都會被走訪以計算節點數，但只有前 maxNodesPerLevel 個會輸出內容
+    template <typename Node, typename IsLeaf>
+    void printLevels(std::ostream& stream, const Node* root, IsLeaf isLeaf, const Limits& limits) {
+        OutputBuffer out(stream);
+        std::vector<const Node*> level;
+        if (root) level.push_back(root);
+        for (int depth = 0; depth < limits.maxDepth && !level.empty(); depth++) {
+            out << "第 " << depth << " 層 (" << level.size() << " 個節點):";
+            bool expand = depth + 1 < limits.maxDepth, deeper = false;
+            std::vector<const Node*> next;
+            for (size_t i = 0; i < level.size(); i++) {
+                const Node* node = level[i];
+                if (i < limits.maxNodesPerLevel) {
+                    out << " [";
+                    if (keyList(out, node, limits.maxKeysPerNode, ' ') < node->keys.size()) out << " ...(共 " << node->keys.size() << " 個)";
+                    out << ']';
+                }
+                if (isLeaf(node)) continue;
+                deeper = true;
+                if (expand) next.insert(next.end(), node->children.begin(), node->children.begin() + node->keys.size() + 1);
+            }
+            if (level.size() > limits.maxNodesPerLevel) out << " ...(省略 " << level.size() - limits.maxNodesPerLevel << " 個節點)";
+            out << '\n';
+            if (deeper && !expand) out << "(第 " << depth + 1 << " 層以下省略)\n";
+            level = std::move(next);
+        }
+    }
+
+    // Graphviz DOT 格式：每個節點為一個 record，鍵值之間的欄位 <c0>、<c1> ... 連到對應的子節點。
+    // 節點依層序編號，超出範圍的節點與其子樹不輸出，只以註解記錄省略的個數
+    template <typename Node, typename IsLeaf>
+    void writeDot(std::ostream& stream, const Node* root, IsLeaf isLeaf, const Limits& limits) {
+        OutputBuffer out(stream);
+        out << "digraph BTree {\n    node [shape=record, fontsize=10];\n";
+        std::vector<const Node*> level;
+        if (root && limits.maxDepth > 0) level.push_back(root);
+        size_t base = 0; // 本層第一個節點的編號
+        for (int depth = 0; !level.empty(); depth++) {
+            size_t shown = std::min(level.size(), limits.maxNodesPerLevel);
+            size_t nextBase = base + shown;
+            bool expand = depth + 1 < limits.maxDepth;
+            std::vector<const Node*> next;
+            for (size_t i = 0; i < shown; i++) {
+                const Node* node = level[i];
+                bool leaf = isLeaf(node);
+                size_t keys = std::min(node->keys.size(), limits.maxKeysPerNode);
+                out << "    n" << base + i << " [label=\"";
+                for (size_t k = 0; k < keys; k++) { // 內部節點為 <c0>|k0|<c1>|k1|...|<cn>，葉節點只有 k0|k1|...
+                    if (!leaf) out << "<c" << k << ">|";
+                    else if (k) out << '|';
+                    out << node->keys[k];
+                    if (!leaf) out << '|';
+                }
+                if (keys < node->keys.size()) out << (leaf && keys ? "|..." : "...") << (leaf ? "" : "|");
+                if (!leaf) out << "<c" << keys << ">";
+                out << "\"];\n";
+                if (leaf || !expand) continue;
+                for (size_t c = 0; c <= node->keys.size(); c++) {
+                    if (next.size() < limits.maxNodesPerLevel) {
+                        out << "    n" << base + i;
+                        if (c <= keys) out << ":c" << c;
+                        out << " -> n" << nextBase + next.size() << ";\n";
+                    }
+                    next.push_back(node->children[c]);
+                }
+            }
+            if (level.size() > shown) out << "    // 第 " << depth << " 層省略 " << level.size() - shown << " 個節點\n";
+            base = nextBase;
+            level = std::move(next);
+        }
+        out << "}\n";
+    }
+
+    template <typename Node, typename IsLeaf>
+    void jsonNode(OutputBuffer& out, const Node* node, int depth, IsLeaf& isLeaf, const Limits& limits, std::vector<size_t>& emitted) {
+        out << "{\"keys\":[";
+        keyList(out, node, limits.maxKeysPerNode, ',');
+        out << ']';
+        if (node->keys.size() > limits.maxKeysPerNode) out << ",\"key_count\":" << node->keys.size();
+        if (!isLeaf(node)) {
+            size_t children = node->keys.size() + 1, written = 0;
+            if (depth + 1 < limits.maxDepth) {
+                if (emitted.size() <= static_cast<size_t>(depth + 1)) emitted.resize(depth + 2, 0);
+                out << ",\"children\":[";
+                for (size_t i = 0; i < children && emitted[depth + 1] < limits.maxNodesPerLevel; i++, written++) {
+                    if (i) out << ',';
+                    emitted[depth + 1]++;
+                    jsonNode(out, node->children[i], depth + 1, isLeaf, limits, emitted);
+                }
+                out << ']';
+            }
+            if (written < children) out << ",\"child_count\":" << children;
+        }
+        out << '}';
+    }
+
+    // JSON 格式：{"keys":[...],"children":[...]} 依樹的結構巢狀輸出 (遞迴深度等於樹高)，空樹為 null。
+    // 鍵值或子節點沒有全部輸出時，另外以 key_count / child_count 記錄原本的個數
+    template <typename Node, typename IsLeaf>
+    void writeJson(std::ostream& stream, const Node* root, IsLeaf isLeaf, const Limits& limits) {
+        OutputBuffer out(stream);
+        std::vector<size_t> emitted(1, 1); // 每一層已輸出的節點數
+        if (root && limits.maxDepth > 0 && limits.maxNodesPerLevel > 0) jsonNode(out, root, 0, isLeaf, limits, emitted);
+        else out << "null";
+        out << '\n';
+    }
+}
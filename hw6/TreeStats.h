@@ -0,0 +1,157 @@
+﻿#pragma once
+#include <ostream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 結構操作計數器；編譯時定義 HW6_NO_STATS 即可移除所有計數，不留任何執行成本
+#ifdef HW6_NO_STATS
+#define HW6_COUNT(field) ((void)0)
+#define HW6_COUNT_N(field, n) ((void)0)
+#else
+#define HW6_COUNT(field) (++stats.field)
+#define HW6_COUNT_N(field, n) (stats.field += (n))
+#endif
+
+// 各種結構操作的呼叫次數
+struct OpStats {
+    uint64_t splitChild = 0;
+    uint64_t merge = 0;
+    uint64_t borrowFromPrev = 0;
+    uint64_t borrowFromNext = 0;
+    uint64_t getPredecessor = 0;
+    uint64_t getSuccessor = 0;
+    uint64_t nodesVisited = 0; // insert / remove / find 下降時經過的節點數
+    uint64_t operations = 0; // insert / remove / find 的次數 (批次操作以鍵值數計)
+    uint64_t nodesCopied = 0; // 寫入時因節點仍被快照共用而複製的節點數 (path copying)
+    uint64_t filterRejects = 0; // membership filter 直接排除、不必走訪樹的查詢數
+
+    // 平均每個操作經過的節點數
+    double nodesPerOperation() const {
+        return operations ? static_cast<double>(nodesVisited) / operations : 0.0;
+    }
+};
+
+// 單一層的形狀
+struct LevelShape {
+    size_t nodes = 0;
+    size_t keys = 0;
+    size_t capacity = 0; // 該層所有節點可容納的鍵值總數
+
+    double fillFactor() const {
+        return capacity ? static_cast<double>(keys) / capacity : 0.0;
+    }
+};
+
+// 整棵樹的形狀，levels[0] 為根節點所在的層
+struct ShapeStats {
+    int height = 0;
+    size_t nodeCount = 0;
+    size_t keyCount = 0;
+    size_t bytes = 0; // 節點本身與其 keys / children 陣列所佔的記憶體
+    std::vector<LevelShape> levels;
+};
+
+// 樹佔用的記憶體 (位元組)：live 為樹上的節點連同其 keys / children 陣列，idle 為已釋放但仍留在 pool 中等待重複使用的節點
+struct MemoryUsage {
+    size_t liveNodes = 0;
+    size_t liveBytes = 0;
+    size_t idleNodes = 0;
+    size_t idleBytes = 0;
+    size_t keys = 0;
+    size_t keyCapacity = 0; // 樹上所有節點可容納的鍵值總數
+
+    size_t totalBytes() const {
+        return liveBytes + idleBytes;
+    }
+
+    // 樹上節點的平均填充率，遠低於建樹時的填充率時適合呼叫 compact
+    double fillFactor() const {
+        return keyCapacity ? static_cast<double>(keys) / keyCapacity : 0.0;
+    }
+};
+
+// 單一節點連同其 keys / children 陣列佔用的記憶體
+template <typename Node>
+size_t nodeBytes(const Node* node) {
+    return sizeof(Node) + node->keys.capacity() * sizeof(node->keys[0]) + node->children.capacity() * sizeof(node->children[0]);
+}
+
+// 以「名稱 數值」逐行輸出，方便監控系統擷取
+inline std::ostream& operator<<(std::ostream& out, const OpStats& s) {
+    out << "split_child " << s.splitChild << "\n"
+        << "merge " << s.merge << "\n"
+        << "borrow_from_prev " << s.borrowFromPrev << "\n"
+        << "borrow_from_next " << s.borrowFromNext << "\n"
+        << "get_predecessor " << s.getPredecessor << "\n"
+        << "get_successor " << s.getSuccessor << "\n"
+        << "nodes_visited " << s.nodesVisited << "\n"
+        << "operations " << s.operations << "\n"
+        << "nodes_copied " << s.nodesCopied << "\n"
+        << "filter_rejects " << s.filterRejects << "\n"
+        << "nodes_per_operation " << s.nodesPerOperation() << "\n";
+    return out;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const ShapeStats& s) {
+    out << "height " << s.height << "\n"
+        << "node_count " << s.nodeCount << "\n"
+        << "key_count " << s.keyCount << "\n"
+        << "bytes " << s.bytes << "\n";
+    for (size_t i = 0; i < s.levels.size(); i++) {
+        out << "level_" << i << "_nodes " << s.levels[i].nodes << "\n"
+            << "level_" << i << "_fill " << s.levels[i].fillFactor() << "\n";
+    }
+    return out;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const MemoryUsage& m) {
+    out << "live_nodes " << m.liveNodes << "\n"
+        << "live_bytes " << m.liveBytes << "\n"
+        << "idle_nodes " << m.idleNodes << "\n"
+        << "idle_bytes " << m.idleBytes << "\n"
+        << "fill_factor " << m.fillFactor() << "\n";
+    return out;
+}
+
+// 逐層走訪計算樹的形狀；Node 需有 keys 與 children，isLeaf(node) 判斷葉節點，maxKeys 為單一節點的鍵值上限
+template <typename Node, typename IsLeaf>
+ShapeStats computeShape(const Node* root, int maxKeys, IsLeaf isLeaf) {
+    ShapeStats shape;
+    std::vector<const Node*> level;
+    if (root) level.push_back(root);
+    while (!level.empty()) {
+        LevelShape row;
+        std::vector<const Node*> next;
+        for (const Node* node : level) {
+            row.nodes++;
+            row.keys += node->keys.size();
+            row.capacity += maxKeys;
+            shape.bytes += nodeBytes(node);
+            if (!isLeaf(node)) {
+                for (size_t i = 0; i <= node->keys.size(); i++) next.push_back(node->children[i]);
+            }
+        }
+        shape.nodeCount += row.nodes;
+        shape.keyCount += row.keys;
+        shape.levels.push_back(row);
+        level = std::move(next);
+    }
+    shape.height = static_cast<int>(shape.levels.size());
+    return shape;
+}
+
+// 由樹的形狀與 pool 中的閒置節點計算記憶體用量
+template <typename Pool>
+MemoryUsage computeMemory(const ShapeStats& shape, const Pool& pool) {
+    MemoryUsage usage;
+    usage.liveNodes = shape.nodeCount;
+    usage.liveBytes = shape.bytes;
+    usage.keys = shape.keyCount;
+    for (const LevelShape& level : shape.levels) usage.keyCapacity += level.capacity;
+    pool.forEachIdle([&](const auto* node) {
+        usage.idleNodes++;
+        usage.idleBytes += nodeBytes(node);
+    });
+    return usage;
+}
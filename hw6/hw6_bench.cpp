@@ -0,0 +1,6 @@
+﻿#include "BenchSuite.h"
+
+// 獨立的微基準測試程式，結果輸出到標準輸出，進度輸出到標準錯誤
+int main(int argc, char* argv[]) {
+    return benchsuite::runSuite(argc, argv);
+}